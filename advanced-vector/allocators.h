@@ -0,0 +1,401 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+inline constexpr size_t kCacheLineSize = 64;
+inline constexpr size_t kPageSize = 4096;
+inline constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+// Аллокатор поверх malloc/free. Умеет увеличивать блок на месте через realloc,
+// поэтому Vector с тривиально переносимыми элементами растёт без копирования.
+// Крупные блоки glibc перемещает через mremap, не копируя страницы
+template <typename T>
+class MallocAllocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "MallocAllocator does not support over-aligned types");
+
+    MallocAllocator() = default;
+
+    template <typename U>
+    MallocAllocator(const MallocAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        void* buf = std::malloc(n * sizeof(T));
+        if (buf == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(buf);
+    }
+
+    void deallocate(T* buf, size_t /*n*/) noexcept {
+        std::free(buf);
+    }
+
+    T* reallocate(T* buf, size_t /*old_n*/, size_t new_n) {
+        void* new_buf = std::realloc(static_cast<void*>(buf), new_n * sizeof(T));
+        if (new_buf == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(new_buf);
+    }
+
+    template <typename U>
+    bool operator==(const MallocAllocator<U>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const MallocAllocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+// Аллокатор, выравнивающий буфер по границе Alignment (например, kCacheLineSize или kPageSize)
+// через выровненный operator new. Позволяет SIMD-коду использовать выровненные загрузки
+template <typename T, size_t Alignment = kCacheLineSize>
+class AlignedAllocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    static_assert((Alignment & (Alignment - 1)) == 0, "alignment must be a power of two");
+    static_assert(Alignment >= alignof(T), "alignment must not be weaker than alignof(T)");
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        ::operator delete(buf, n * sizeof(T), std::align_val_t{Alignment});
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return false;
+    }
+};
+
+namespace detail {
+
+// Размерные классы кэша RecyclingAllocator: блоки по 2^k байт от 16 байт до 128 МБ.
+// Большие блоки выделяются точного размера и не кэшируются
+inline constexpr size_t kMinRecyclingClass = 4;
+inline constexpr size_t kRecyclingClasses = 24;
+inline constexpr size_t kMaxRecycledBytes = size_t{1} << (kMinRecyclingClass + kRecyclingClasses - 1);
+
+inline constexpr size_t kDefaultRecyclingCap = 8;
+inline constexpr size_t kDefaultMaxCachedBytes = size_t{1} << 20;
+
+// Ограничения, заданные SetRecyclingCap, увеличенные на 1. Ноль - значение по умолчанию
+inline std::atomic<size_t> recycling_caps[kRecyclingClasses] = {};
+
+inline size_t RecyclingClass(size_t bytes) noexcept {
+    size_t cls = kMinRecyclingClass;
+    while ((size_t{1} << cls) < bytes) {
+        ++cls;
+    }
+    return cls - kMinRecyclingClass;
+}
+
+inline size_t RecyclingClassBytes(size_t cls) noexcept {
+    return size_t{1} << (cls + kMinRecyclingClass);
+}
+
+// Сколько свободных блоков класса cls хранит кэш одного потока
+inline size_t RecyclingCap(size_t cls) noexcept {
+    const size_t cap = recycling_caps[cls].load(std::memory_order_relaxed);
+    if (cap != 0) {
+        return cap - 1;
+    }
+    return RecyclingClassBytes(cls) <= kDefaultMaxCachedBytes ? kDefaultRecyclingCap : 0;
+}
+
+// Свободный блок хранит указатель на следующий прямо в себе
+struct RecycledBlock {
+    RecycledBlock* next;
+};
+
+// Тривиально разрушаемое хранилище, поэтому к нему можно обращаться из деструкторов других
+// thread_local объектов. Блоки освобождает RecyclingCacheGuard при завершении потока
+struct RecyclingCache {
+    RecycledBlock* heads[kRecyclingClasses];
+    size_t counts[kRecyclingClasses];
+    bool closed;
+};
+
+inline thread_local RecyclingCache recycling_cache = {};
+
+inline void TrimRecyclingCache(RecyclingCache& cache, size_t keep) noexcept {
+    for (size_t cls = 0; cls < kRecyclingClasses; ++cls) {
+        while (cache.counts[cls] > keep) {
+            RecycledBlock* block = cache.heads[cls];
+            cache.heads[cls] = block->next;
+            --cache.counts[cls];
+            ::operator delete(block, RecyclingClassBytes(cls));
+        }
+    }
+}
+
+struct RecyclingCacheGuard {
+    ~RecyclingCacheGuard() {
+        TrimRecyclingCache(recycling_cache, 0);
+        recycling_cache.closed = true;
+    }
+};
+
+inline RecyclingCache& ThreadRecyclingCache() noexcept {
+    thread_local RecyclingCacheGuard guard;
+    (void)guard;
+    return recycling_cache;
+}
+
+}  // namespace detail
+
+// Сколько свободных блоков размера block_bytes (округляется вверх до степени двойки) хранит
+// кэш каждого потока. 0 отключает кэширование блоков этого размера.
+// По умолчанию хранится до 8 блоков каждого размера до 1 МБ
+inline void SetRecyclingCap(size_t block_bytes, size_t max_blocks) noexcept {
+    if (block_bytes <= detail::kMaxRecycledBytes) {
+        detail::recycling_caps[detail::RecyclingClass(block_bytes)].store(max_blocks + 1, std::memory_order_relaxed);
+    }
+}
+
+// Освобождает свободные блоки кэша текущего потока, оставляя не более keep блоков каждого размера
+inline void TrimRecyclingCache(size_t keep = 0) noexcept {
+    detail::TrimRecyclingCache(detail::ThreadRecyclingCache(), keep);
+}
+
+// Суммарный размер свободных блоков в кэше текущего потока
+inline size_t RecyclingCachedBytes() noexcept {
+    const detail::RecyclingCache& cache = detail::ThreadRecyclingCache();
+    size_t bytes = 0;
+    for (size_t cls = 0; cls < detail::kRecyclingClasses; ++cls) {
+        bytes += cache.counts[cls] * detail::RecyclingClassBytes(cls);
+    }
+    return bytes;
+}
+
+// Аллокатор для короткоживущих векторов. Размер блока до 128 МБ округляется до степени двойки,
+// а освобождённый блок попадает в кэш текущего потока и отдаётся следующему запросу того же
+// размера без обращения к operator new. Кэш ограничен SetRecyclingCap и освобождается
+// TrimRecyclingCache или при завершении потока. Блок можно освободить в другом потоке:
+// он попадёт в кэш этого потока
+template <typename T>
+class RecyclingAllocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                  "RecyclingAllocator does not support over-aligned types");
+
+    RecyclingAllocator() = default;
+
+    template <typename U>
+    RecyclingAllocator(const RecyclingAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        const size_t bytes = n * sizeof(T);
+        if (bytes > detail::kMaxRecycledBytes) {
+            return static_cast<T*>(::operator new(bytes));
+        }
+        const size_t cls = detail::RecyclingClass(bytes);
+        detail::RecyclingCache& cache = detail::ThreadRecyclingCache();
+        if (cache.counts[cls] != 0) {
+            detail::RecycledBlock* block = cache.heads[cls];
+            cache.heads[cls] = block->next;
+            --cache.counts[cls];
+            return reinterpret_cast<T*>(block);
+        }
+        return static_cast<T*>(::operator new(detail::RecyclingClassBytes(cls)));
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+        if (bytes > detail::kMaxRecycledBytes) {
+            ::operator delete(buf, bytes);
+            return;
+        }
+        const size_t cls = detail::RecyclingClass(bytes);
+        detail::RecyclingCache& cache = detail::ThreadRecyclingCache();
+        if (!cache.closed && cache.counts[cls] < detail::RecyclingCap(cls)) {
+            auto* block = reinterpret_cast<detail::RecycledBlock*>(buf);
+            block->next = cache.heads[cls];
+            cache.heads[cls] = block;
+            ++cache.counts[cls];
+            return;
+        }
+        ::operator delete(buf, detail::RecyclingClassBytes(cls));
+    }
+
+    template <typename U>
+    bool operator==(const RecyclingAllocator<U>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const RecyclingAllocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+#if defined(__linux__)
+
+enum class HugePages {
+    // Прозрачные huge pages: обычное отображение с madvise(MADV_HUGEPAGE)
+    kTransparent,
+    // Явные 2 МБ страницы (MAP_HUGETLB) из пула vm.nr_hugepages. Если пул пуст,
+    // используются прозрачные huge pages
+    kExplicit,
+};
+
+// Аллокатор для крупных буферов. Блоки от kHugePageSize байт отображаются через mmap
+// и выравниваются по 2 МБ, что сокращает промахи TLB. Меньшие блоки выделяются operator new
+// с выравниванием по строке кэша. Блоки из mmap растут через mremap без копирования страниц
+template <typename T, HugePages Mode = HugePages::kTransparent>
+class HugePageAllocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    static_assert(alignof(T) <= kCacheLineSize, "HugePageAllocator does not support such alignment");
+
+    template <typename U>
+    struct rebind {
+        using other = HugePageAllocator<U, Mode>;
+    };
+
+    HugePageAllocator() = default;
+
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U, Mode>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        const size_t bytes = n * sizeof(T);
+        if (!IsMapped(bytes)) {
+            return static_cast<T*>(::operator new(bytes, std::align_val_t{kCacheLineSize}));
+        }
+        return static_cast<T*>(Map(RoundUp(bytes)));
+    }
+
+    void deallocate(T* buf, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+        if (!IsMapped(bytes)) {
+            ::operator delete(buf, bytes, std::align_val_t{kCacheLineSize});
+        } else {
+            munmap(buf, RoundUp(bytes));
+        }
+    }
+
+    // Вызывается Vector только для тривиально переносимых T, поэтому содержимое можно копировать побайтово
+    T* reallocate(T* buf, size_t old_n, size_t new_n) {
+        const size_t old_bytes = old_n * sizeof(T);
+        const size_t new_bytes = new_n * sizeof(T);
+        if constexpr (Mode == HugePages::kTransparent) {
+            if (IsMapped(old_bytes) && IsMapped(new_bytes)) {
+                const size_t old_size = RoundUp(old_bytes);
+                const size_t new_size = RoundUp(new_bytes);
+                // Сначала блок пробуется расширить на месте: адрес и выравнивание не меняются
+                void* new_buf = mremap(buf, old_size, new_size, 0);
+                if (new_buf == MAP_FAILED) {
+                    // MREMAP_MAYMOVE сам выбрал бы адрес без выравнивания по 2 МБ, поэтому страницы
+                    // переносятся в заранее отображённый выровненный блок
+                    void* target = Map(new_size);
+                    new_buf = mremap(buf, old_size, new_size, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+                    if (new_buf == MAP_FAILED) {
+                        munmap(target, new_size);
+                        throw std::bad_alloc();
+                    }
+                }
+                madvise(new_buf, new_size, MADV_HUGEPAGE);
+                return static_cast<T*>(new_buf);
+            }
+        }
+        T* new_buf = allocate(new_n);
+        std::memcpy(static_cast<void*>(new_buf), static_cast<const void*>(buf), std::min(old_bytes, new_bytes));
+        deallocate(buf, old_n);
+        return new_buf;
+    }
+
+    template <typename U>
+    bool operator==(const HugePageAllocator<U, Mode>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const HugePageAllocator<U, Mode>&) const noexcept {
+        return false;
+    }
+
+private:
+    static bool IsMapped(size_t bytes) noexcept {
+        return bytes >= kHugePageSize;
+    }
+
+    static size_t RoundUp(size_t bytes) noexcept {
+        return (bytes + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+    }
+
+    static void* Map(size_t bytes) {
+        constexpr int kFlags = MAP_PRIVATE | MAP_ANONYMOUS;
+        if constexpr (Mode == HugePages::kExplicit) {
+            void* buf = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, kFlags | MAP_HUGETLB, -1, 0);
+            if (buf != MAP_FAILED) {
+                return buf;
+            }
+        }
+        // Отображение с запасом в одну huge page обрезается до адреса, кратного 2 МБ
+        void* raw = mmap(nullptr, bytes + kHugePageSize, PROT_READ | PROT_WRITE, kFlags, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        const auto addr = reinterpret_cast<uintptr_t>(raw);
+        const uintptr_t aligned = (addr + kHugePageSize - 1) / kHugePageSize * kHugePageSize;
+        if (aligned != addr) {
+            munmap(raw, aligned - addr);
+        }
+        munmap(reinterpret_cast<void*>(aligned + bytes), addr + kHugePageSize - aligned);
+        void* buf = reinterpret_cast<void*>(aligned);
+        madvise(buf, bytes, MADV_HUGEPAGE);
+        return buf;
+    }
+};
+
+#endif  // defined(__linux__)
@@ -0,0 +1,553 @@
+#pragma once
+#include "serialization.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define ADVANCED_VECTOR_HAS_IO_URING 1
+#else
+#define ADVANCED_VECTOR_HAS_IO_URING 0
+#endif
+
+// Асинхронные Load и Save в формате serialization.h. Буфер элементов делится на порции, до
+// queue_depth порций читаются или пишутся одновременно через io_uring, а если ядро его не
+// поддерживает - пулом потоков с pread/pwrite. Порции можно обрабатывать по мере
+// загрузки: WaitUntil(n) ждёт только первые n элементов
+
+enum class AsyncBackend {
+    // io_uring, если доступен, иначе пул потоков
+    kAuto,
+    kIoUring,
+    kThreads,
+};
+
+struct AsyncIoOptions {
+    // Размер одной операции чтения или записи
+    size_t chunk_bytes = size_t{1} << 20;
+    // Сколько порций передаётся одновременно: глубина очереди io_uring или число потоков
+    size_t queue_depth = 16;
+    AsyncBackend backend = AsyncBackend::kAuto;
+    // Смещение заголовка вектора в файле. Позиция дескриптора не меняется
+    off_t offset = 0;
+};
+
+namespace detail {
+
+enum class TransferKind {
+    kRead,
+    kWrite,
+};
+
+// Читает или пишет ровно bytes байт с позиции offset
+inline void TransferAll(int fd, TransferKind kind, char* data, size_t bytes, off_t offset) {
+    while (bytes > 0) {
+        const ssize_t done = kind == TransferKind::kRead ? ::pread(fd, data, bytes, offset)
+                                                         : ::pwrite(fd, data, bytes, offset);
+        if (done < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowSystemError(kind == TransferKind::kRead ? "pread" : "pwrite");
+        }
+        if (done == 0) {
+            throw std::runtime_error("unexpected end of vector data");
+        }
+        data += done;
+        bytes -= static_cast<size_t>(done);
+        offset += done;
+    }
+}
+
+#if ADVANCED_VECTOR_HAS_IO_URING
+
+// Минимальное кольцо io_uring на системных вызовах, без liburing. Используется одним потоком
+class IoUring {
+public:
+    IoUring() = default;
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    ~IoUring() {
+        if (sqes_ != nullptr) {
+            ::munmap(sqes_, sqes_bytes_);
+        }
+        if (cq_map_ != nullptr && cq_map_ != sq_map_) {
+            ::munmap(cq_map_, cq_bytes_);
+        }
+        if (sq_map_ != nullptr) {
+            ::munmap(sq_map_, sq_bytes_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    // false, если ядро не поддерживает io_uring или запрещает его; errno содержит причину
+    bool Init(unsigned entries) noexcept {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd_ < 0) {
+            return false;
+        }
+        entries_ = params.sq_entries;
+        sq_bytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_bytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_bytes_ = cq_bytes_ = std::max(sq_bytes_, cq_bytes_);
+        }
+        sq_map_ = Map(sq_bytes_, IORING_OFF_SQ_RING);
+        if (sq_map_ == nullptr) {
+            return false;
+        }
+        cq_map_ = single_mmap ? sq_map_ : Map(cq_bytes_, IORING_OFF_CQ_RING);
+        if (cq_map_ == nullptr) {
+            return false;
+        }
+        // Каждое отображение запоминается сразу, чтобы при неудаче следующего его освободил деструктор
+        sqes_bytes_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(Map(sqes_bytes_, IORING_OFF_SQES));
+        if (sqes_ == nullptr) {
+            return false;
+        }
+        auto* sq = static_cast<char*>(sq_map_);
+        sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        auto* cq = static_cast<char*>(cq_map_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    // Ставит в очередь чтение или запись. false, если очередь заполнена
+    bool Push(TransferKind kind, int fd, char* data, unsigned bytes, off_t offset, uint64_t user_data) noexcept {
+        const unsigned tail = *sq_tail_;
+        if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= entries_) {
+            return false;
+        }
+        const unsigned index = tail & sq_mask_;
+        io_uring_sqe& sqe = sqes_[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = kind == TransferKind::kRead ? IORING_OP_READ : IORING_OP_WRITE;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<uintptr_t>(data);
+        sqe.len = bytes;
+        sqe.off = static_cast<uint64_t>(offset);
+        sqe.user_data = user_data;
+        sq_array_[index] = index;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        ++pending_;
+        return true;
+    }
+
+    // Отправляет поставленные операции и ждёт хотя бы min_complete завершений
+    void Enter(unsigned min_complete) {
+        for (;;) {
+            const long submitted = ::syscall(__NR_io_uring_enter, fd_, pending_, min_complete,
+                                             min_complete > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+            if (submitted >= 0) {
+                pending_ -= static_cast<unsigned>(submitted);
+                return;
+            }
+            if (errno != EINTR) {
+                ThrowSystemError("io_uring_enter");
+            }
+        }
+    }
+
+    // Вызывает handle(user_data, res) для каждого завершения
+    template <typename Handler>
+    void Reap(Handler handle) {
+        unsigned head = *cq_head_;
+        const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+            handle(cqe.user_data, cqe.res);
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    }
+
+private:
+    void* Map(size_t bytes, off_t offset) noexcept {
+        void* map = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+        return map == MAP_FAILED ? nullptr : map;
+    }
+
+    int fd_ = -1;
+    unsigned entries_ = 0;
+    unsigned pending_ = 0;
+    void* sq_map_ = nullptr;
+    void* cq_map_ = nullptr;
+    size_t sq_bytes_ = 0;
+    size_t cq_bytes_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqes_bytes_ = 0;
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned* sq_array_ = nullptr;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+};
+
+#endif  // ADVANCED_VECTOR_HAS_IO_URING
+
+// Передача буфера порциями в фоновых потоках. Порции завершаются в любом порядке, наружу
+// сообщается длина готового префикса. При первой ошибке оставшиеся порции не начинаются
+class ChunkedTransfer {
+public:
+    ChunkedTransfer(int fd, TransferKind kind, char* data, size_t bytes, off_t offset, const AsyncIoOptions& options)
+        : fd_(fd)
+        , kind_(kind)
+        , data_(data)
+        , bytes_(bytes)
+        , offset_(offset)
+        , chunk_bytes_(options.chunk_bytes)
+        , chunks_((bytes + options.chunk_bytes - 1) / options.chunk_bytes)
+        , done_(chunks_, false) {
+        assert(chunk_bytes_ > 0 && chunk_bytes_ <= (size_t{1} << 30));
+        if (chunks_ == 0) {
+            return;
+        }
+        const size_t depth = std::clamp<size_t>(options.queue_depth, 1, chunks_);
+#if ADVANCED_VECTOR_HAS_IO_URING
+        if (options.backend != AsyncBackend::kThreads) {
+            auto ring = std::make_unique<IoUring>();
+            if (ring->Init(static_cast<unsigned>(depth))) {
+                workers_.emplace_back([this, depth, ring = std::move(ring)] { RunRing(*ring, depth); });
+                return;
+            }
+            if (options.backend == AsyncBackend::kIoUring) {
+                ThrowSystemError("io_uring_setup");
+            }
+        }
+#else
+        if (options.backend == AsyncBackend::kIoUring) {
+            throw std::system_error(std::make_error_code(std::errc::function_not_supported), "io_uring");
+        }
+#endif
+        try {
+            for (size_t i = 0; i < depth; ++i) {
+                workers_.emplace_back([this] { RunWorker(); });
+            }
+        } catch (...) {
+            cancelled_.store(true, std::memory_order_relaxed);
+            Join();
+            throw;
+        }
+    }
+
+    ChunkedTransfer(const ChunkedTransfer&) = delete;
+    ChunkedTransfer& operator=(const ChunkedTransfer&) = delete;
+
+    ~ChunkedTransfer() {
+        Cancel();
+    }
+
+    // Отменяет незавершённые порции и дожидается начатых. Возвращает true, если все байты
+    // переданы без ошибок
+    bool Cancel() noexcept {
+        cancelled_.store(true, std::memory_order_relaxed);
+        Join();
+        std::lock_guard lock(mutex_);
+        return !error_ && ReadyBytesLocked() == bytes_;
+    }
+
+    size_t ReadyBytes() const {
+        std::lock_guard lock(mutex_);
+        return ReadyBytesLocked();
+    }
+
+    // Ждёт, пока первые bytes байт не будут переданы. Ошибка передачи выбрасывается
+    void WaitBytes(size_t bytes) {
+        std::unique_lock lock(mutex_);
+        cv_.wait(lock, [&] { return ReadyBytesLocked() >= std::min(bytes, bytes_) || error_; });
+        if (ReadyBytesLocked() < std::min(bytes, bytes_)) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+    // Ждёт окончания всех потоков передачи и выбрасывает ошибку, если она была
+    void Wait() {
+        Join();
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+private:
+    size_t ReadyBytesLocked() const noexcept {
+        return std::min(ready_chunks_ * chunk_bytes_, bytes_);
+    }
+
+    size_t ChunkSize(size_t chunk) const noexcept {
+        return std::min(chunk_bytes_, bytes_ - chunk * chunk_bytes_);
+    }
+
+    void Join() noexcept {
+        for (std::thread& worker : workers_) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+
+    void Complete(size_t chunk) {
+        std::lock_guard lock(mutex_);
+        done_[chunk] = true;
+        while (ready_chunks_ < chunks_ && done_[ready_chunks_]) {
+            ++ready_chunks_;
+        }
+        cv_.notify_all();
+    }
+
+    void Fail(std::exception_ptr error) noexcept {
+        cancelled_.store(true, std::memory_order_relaxed);
+        std::lock_guard lock(mutex_);
+        if (!error_) {
+            error_ = std::move(error);
+        }
+        cv_.notify_all();
+    }
+
+    // Поток пула: порции берутся по возрастанию, чтобы готовый префикс рос равномерно
+    void RunWorker() noexcept {
+        while (!cancelled_.load(std::memory_order_relaxed)) {
+            const size_t chunk = next_chunk_.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= chunks_) {
+                return;
+            }
+            try {
+                TransferAll(fd_, kind_, data_ + chunk * chunk_bytes_, ChunkSize(chunk),
+                            offset_ + static_cast<off_t>(chunk * chunk_bytes_));
+                Complete(chunk);
+            } catch (...) {
+                Fail(std::current_exception());
+            }
+        }
+    }
+
+#if ADVANCED_VECTOR_HAS_IO_URING
+    // Единственный поток, владеющий кольцом: держит в очереди до depth порций, короткие
+    // чтения и записи дочитывает тем же запросом
+    void RunRing(IoUring& ring, size_t depth) noexcept {
+        std::vector<size_t> progress(chunks_, 0);
+        std::vector<size_t> retry;
+        size_t next = 0;
+        size_t in_flight = 0;
+        const auto push = [&](size_t chunk) {
+            const size_t at = chunk * chunk_bytes_ + progress[chunk];
+            return ring.Push(kind_, fd_, data_ + at, static_cast<unsigned>(ChunkSize(chunk) - progress[chunk]),
+                             offset_ + static_cast<off_t>(at), chunk);
+        };
+        try {
+            for (;;) {
+                while (in_flight < depth && !cancelled_.load(std::memory_order_relaxed)
+                       && (!retry.empty() || next < chunks_)) {
+                    const size_t chunk = retry.empty() ? next : retry.back();
+                    if (!push(chunk)) {
+                        break;
+                    }
+                    if (retry.empty()) {
+                        ++next;
+                    } else {
+                        retry.pop_back();
+                    }
+                    ++in_flight;
+                }
+                if (in_flight == 0) {
+                    return;
+                }
+                ring.Enter(1);
+                ring.Reap([&](uint64_t chunk, int res) {
+                    --in_flight;
+                    if (res == -EINTR || res == -EAGAIN) {
+                        retry.push_back(chunk);
+                    } else if (res < 0) {
+                        errno = -res;
+                        try {
+                            ThrowSystemError(kind_ == TransferKind::kRead ? "io_uring read" : "io_uring write");
+                        } catch (...) {
+                            Fail(std::current_exception());
+                        }
+                    } else if (res == 0) {
+                        Fail(std::make_exception_ptr(std::runtime_error("unexpected end of vector data")));
+                    } else if ((progress[chunk] += static_cast<size_t>(res)) < ChunkSize(chunk)) {
+                        retry.push_back(chunk);
+                    } else {
+                        Complete(chunk);
+                    }
+                });
+            }
+        } catch (...) {
+            // Кольцо неисправно: запросы в полёте отменит ядро при закрытии кольца
+            Fail(std::current_exception());
+        }
+    }
+#endif
+
+    const int fd_;
+    const TransferKind kind_;
+    char* const data_;
+    const size_t bytes_;
+    const off_t offset_;
+    const size_t chunk_bytes_;
+    const size_t chunks_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<bool> done_;
+    size_t ready_chunks_ = 0;
+    std::exception_ptr error_;
+
+    std::atomic<size_t> next_chunk_ = 0;
+    std::atomic<bool> cancelled_ = false;
+    std::vector<std::thread> workers_;
+};
+
+// Читает ровно bytes байт с позиции offset, не меняя позицию дескриптора
+inline void PreadAll(int fd, void* buf, size_t bytes, off_t offset) {
+    TransferAll(fd, TransferKind::kRead, static_cast<char*>(buf), bytes, offset);
+}
+
+}  // namespace detail
+
+// Загрузка, начатая LoadAsync. Вектор нельзя использовать до окончания загрузки, кроме
+// первых ReadyCount() элементов. Разрушение незавершённой загрузки отменяет её
+template <typename T, typename... Params>
+class AsyncLoad {
+public:
+    AsyncLoad(Vector<T, Params...>& vec, std::unique_ptr<detail::ChunkedTransfer> transfer) noexcept
+        : vec_(&vec)
+        , transfer_(std::move(transfer)) {
+    }
+
+    AsyncLoad(AsyncLoad&&) noexcept = default;
+
+    AsyncLoad& operator=(AsyncLoad&& rhs) noexcept {
+        if (this != &rhs) {
+            Finish();
+            vec_ = rhs.vec_;
+            transfer_ = std::move(rhs.transfer_);
+        }
+        return *this;
+    }
+
+    // Загрузка, которую не дождались через Wait, отменяется. Если элементы загружены не все,
+    // вектор очищается, как в Load
+    ~AsyncLoad() {
+        Finish();
+    }
+
+    // Число элементов в файле
+    size_t Size() const noexcept {
+        return vec_->Size();
+    }
+
+    // Сколько первых элементов уже загружено
+    size_t ReadyCount() const {
+        return transfer_->ReadyBytes() / sizeof(T);
+    }
+
+    // Ждёт загрузки первых count элементов и возвращает указатель на них. Ошибка загрузки выбрасывается
+    const T* WaitUntil(size_t count) {
+        assert(count <= Size());
+        transfer_->WaitBytes(count * sizeof(T));
+        return vec_->Data();
+    }
+
+    // Ждёт окончания загрузки. При ошибке вектор очищается, как в Load
+    Vector<T, Params...>& Wait() {
+        try {
+            transfer_->Wait();
+        } catch (...) {
+            vec_->Clear();
+            throw;
+        }
+        return *vec_;
+    }
+
+private:
+    void Finish() noexcept {
+        if (transfer_ != nullptr && !transfer_->Cancel()) {
+            vec_->Clear();
+        }
+    }
+
+    Vector<T, Params...>* vec_;
+    std::unique_ptr<detail::ChunkedTransfer> transfer_;
+};
+
+// Запись, начатая SaveAsync. Вектор нельзя изменять до её окончания
+class AsyncSave {
+public:
+    explicit AsyncSave(std::unique_ptr<detail::ChunkedTransfer> transfer) noexcept
+        : transfer_(std::move(transfer)) {
+    }
+
+    // Сколько байт элементов уже записано подряд с начала
+    size_t ReadyBytes() const {
+        return transfer_->ReadyBytes();
+    }
+
+    void Wait() {
+        transfer_->Wait();
+    }
+
+private:
+    std::unique_ptr<detail::ChunkedTransfer> transfer_;
+};
+
+// Начинает чтение вектора, записанного Save, с позиции options.offset. Заголовок читается сразу,
+// память выделяется один раз, элементы загружаются в фоне
+template <typename T, typename... Params>
+AsyncLoad<T, Params...> LoadAsync(int fd, Vector<T, Params...>& vec, const AsyncIoOptions& options = {}) {
+    detail::CheckSerializable<T>();
+    vec.Clear();
+    try {
+        unsigned char block[kVectorDataOffset];
+        detail::PreadAll(fd, block, sizeof(block), options.offset);
+        const size_t size = detail::CheckedVectorSize<T>(block);
+        detail::CheckVectorFits<T>(fd, size, options.offset + static_cast<off_t>(kVectorDataOffset));
+        vec.ResizeDefaultInit(size);
+        auto transfer = std::make_unique<detail::ChunkedTransfer>(
+            fd, detail::TransferKind::kRead, reinterpret_cast<char*>(vec.Data()), vec.Size() * sizeof(T),
+            options.offset + static_cast<off_t>(kVectorDataOffset), options);
+        return AsyncLoad<T, Params...>(vec, std::move(transfer));
+    } catch (...) {
+        vec.Clear();
+        throw;
+    }
+}
+
+// Начинает запись вектора в формате Save с позиции options.offset. Заголовок пишется сразу
+template <typename T, typename... Params>
+AsyncSave SaveAsync(int fd, const Vector<T, Params...>& vec, const AsyncIoOptions& options = {}) {
+    detail::CheckSerializable<T>();
+    unsigned char block[kVectorDataOffset] = {};
+    const VectorFileHeader header = MakeVectorFileHeader<T>(vec.Size());
+    std::memcpy(block, &header, sizeof(header));
+    detail::TransferAll(fd, detail::TransferKind::kWrite, reinterpret_cast<char*>(block), sizeof(block),
+                        options.offset);
+    return AsyncSave(std::make_unique<detail::ChunkedTransfer>(
+        fd, detail::TransferKind::kWrite, const_cast<char*>(reinterpret_cast<const char*>(vec.Data())),
+        vec.Size() * sizeof(T), options.offset + static_cast<off_t>(kVectorDataOffset), options));
+}
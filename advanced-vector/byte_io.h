@@ -0,0 +1,169 @@
+#pragma once
+#include "vector.h"
+
+#include <array>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <istream>
+#include <limits>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Чтение байтов прямо в свободный хвост вектора без промежуточного буфера. Функции для
+// дескрипторов возвращают число прочитанных байт, 0 в конце файла и -1, если неблокирующий
+// дескриптор не готов (EAGAIN). Остальные ошибки выбрасываются как std::system_error
+
+namespace detail {
+
+template <typename T>
+constexpr void CheckByteElement() noexcept {
+    static_assert(sizeof(T) == 1 && std::is_trivially_copyable_v<T>,
+                  "bytes can only be read into vectors of char, unsigned char or std::byte");
+}
+
+// Повторяет вызов read/recv/readv после EINTR. EAGAIN дает -1, остальные ошибки - исключение
+template <typename Call>
+ssize_t RetryRead(Call call, const char* what) {
+    for (;;) {
+        const ssize_t got = call();
+        if (got >= 0) {
+            return got;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return -1;
+        }
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+}
+
+// Размер одного чтения из потока без подсказки о числе доступных байт
+inline constexpr size_t kMinStreamChunk = 4096;
+
+}  // namespace detail
+
+// Дописывает в конец vec не более max байт одним вызовом read
+template <typename T, typename... Params>
+ssize_t ReadFrom(int fd, Vector<T, Params...>& vec, size_t max) {
+    detail::CheckByteElement<T>();
+    ssize_t result = 0;
+    vec.AppendAndOverwrite(max, [&](T* dst, size_t count) {
+        result = detail::RetryRead([&] { return ::read(fd, dst, count); }, "read");
+        return result > 0 ? static_cast<size_t>(result) : 0;
+    });
+    return result;
+}
+
+// То же для сокета через recv с флагами flags (MSG_DONTWAIT, MSG_WAITALL и т. п.)
+template <typename T, typename... Params>
+ssize_t RecvFrom(int fd, Vector<T, Params...>& vec, size_t max, int flags = 0) {
+    detail::CheckByteElement<T>();
+    ssize_t result = 0;
+    vec.AppendAndOverwrite(max, [&](T* dst, size_t count) {
+        result = detail::RetryRead([&] { return ::recv(fd, dst, count, flags); }, "recv");
+        return result > 0 ? static_cast<size_t>(result) : 0;
+    });
+    return result;
+}
+
+// Часть одного readv: не более max байт в конец вектора vec
+template <typename Vec>
+struct ReadSlot {
+    ReadSlot(Vec& vec, size_t max) noexcept
+        : vec(vec)
+        , max(max) {
+    }
+
+    Vec& vec;
+    size_t max;
+};
+
+namespace detail {
+
+// Открывает хвосты векторов слотов I, I+1, ... вложенными AppendAndOverwrite, на последнем уровне
+// вызывает readv и раздаёт прочитанные байты слотам по порядку. offset - сумма max предыдущих слотов.
+// Векторы слотов должны быть разными: вложенный AppendAndOverwrite того же вектора перевыделил бы
+// буфер, в который указывает уже собранный iovec
+template <size_t I, typename Slots, size_t N>
+void ReadvSlots(int fd, Slots& slots, std::array<iovec, N>& iov, size_t offset, ssize_t& result) {
+    if constexpr (I == N) {
+        result = RetryRead([&] { return ::readv(fd, iov.data(), static_cast<int>(N)); }, "readv");
+    } else {
+        auto& slot = std::get<I>(slots);
+        slot.vec.AppendAndOverwrite(slot.max, [&](auto* dst, size_t count) {
+            iov[I] = {dst, count};
+            ReadvSlots<I + 1>(fd, slots, iov, offset + count, result);
+            const size_t got = result > 0 ? static_cast<size_t>(result) : 0;
+            return got > offset ? std::min(got - offset, count) : 0;
+        });
+    }
+}
+
+template <size_t N>
+bool AllDistinct(const std::array<const void*, N>& addresses) noexcept {
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = i + 1; j < N; ++j) {
+            if (addresses[i] == addresses[j]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace detail
+
+// Читает одним readv в хвосты нескольких векторов: первые slots.max байт в первый вектор,
+// следующие - во второй и т. д. Например, заголовок фиксированной длины и тело сообщения:
+// ReadvInto(fd, ReadSlot(header, 16), ReadSlot(body, 65536)). Каждый вектор может входить только в один слот
+template <typename... Vecs>
+ssize_t ReadvInto(int fd, ReadSlot<Vecs>... slots) {
+    static_assert(sizeof...(Vecs) > 0, "at least one slot is required");
+    (detail::CheckByteElement<typename Vecs::value_type>(), ...);
+    assert(detail::AllDistinct(std::array<const void*, sizeof...(Vecs)>{static_cast<const void*>(&slots.vec)...}));
+    std::tuple<ReadSlot<Vecs>...> slot_tuple(slots...);
+    std::array<iovec, sizeof...(Vecs)> iov{};
+    ssize_t result = 0;
+    detail::ReadvSlots<0>(fd, slot_tuple, iov, 0, result);
+    return result;
+}
+
+// Дописывает в конец vec байты потока до его конца, но не более max. Буфер растёт
+// геометрически, первая порция берётся по числу уже доступных в буфере потока байт.
+// Ошибки потока сообщаются через std::ios_base::failure. Возвращает число добавленных байт
+template <typename T, typename... Params>
+size_t AppendFrom(std::istream& in, Vector<T, Params...>& vec, size_t max = std::numeric_limits<size_t>::max()) {
+    detail::CheckByteElement<T>();
+    const size_t old_size = vec.Size();
+    const std::streamsize available = in.rdbuf() != nullptr ? in.rdbuf()->in_avail() : 0;
+    size_t hint = available > 0 ? static_cast<size_t>(available) : detail::kMinStreamChunk;
+    while (max > 0) {
+        // Заполняем всю свободную вместимость, чтобы следующий рост был геометрическим
+        const size_t spare = vec.Capacity() - vec.Size();
+        const size_t chunk = std::min(max, std::max(spare, hint));
+        constexpr size_t kMaxStreamsize = static_cast<size_t>(std::numeric_limits<std::streamsize>::max());
+        const size_t got = vec.AppendAndOverwrite(std::min(chunk, kMaxStreamsize), [&](T* dst, size_t count) {
+            in.read(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(count));
+            return static_cast<size_t>(in.gcount());
+        });
+        max -= got;
+        if (in.bad()) {
+            throw std::ios_base::failure("failed to read stream data");
+        }
+        if (!in) {
+            break;
+        }
+        hint = detail::kMinStreamChunk;
+    }
+    return vec.Size() - old_size;
+}
@@ -0,0 +1,168 @@
+#pragma once
+#include "segmented_vector.h"
+
+#include <memory>
+
+// Вектор для одновременного добавления элементов из многих потоков. Слоты резервируются
+// одним fetch_add, элементы живут в сегментах RawMemory геометрически растущего размера
+// и никогда не перемещаются. Элемент становится видимым читателям после публикации
+// флага готовности его слота. Разрушение, Clear и ForEach не потокобезопасны.
+//
+// Гарантия продвижения: EmplaceBack, GrowBy, IsReady и operator[] не ждут друг друга (wait-free
+// с точностью до аллокатора). Каждый поток, не нашедший нужного сегмента, выделяет свой
+// и публикует его одним CAS; проигравшие гонку освобождают кандидата и пишут в сегмент
+// победителя. При выделении память элементов не трогается, обнуляются только флаги готовности,
+// поэтому лишний кандидат стоит одного выделения памяти. Сегменты растут геометрически,
+// так что таких гонок O(log n)
+template <typename T, size_t FirstSegment = 64>
+class ConcurrentVector {
+    using Layout = detail::GeometricSegments<FirstSegment>;
+
+    static constexpr size_t kMaxSegments = std::numeric_limits<size_t>::digits - Layout::kFirstSegmentLog2;
+
+    // Размер строки кэша: счётчик размера не должен делить строку с таблицей сегментов
+    static constexpr size_t kCacheLine = 64;
+
+    // Элементы и флаги готовности хранятся отдельно: флаги обнуляются при выделении,
+    // а память элементов остаётся сырой до конструирования
+    struct Segment {
+        explicit Segment(size_t capacity)
+            : elements(capacity)
+            , ready(capacity) {
+            std::uninitialized_value_construct_n(ready.GetAddress(), capacity);
+        }
+
+        RawMemory<T> elements;
+        RawMemory<std::atomic<bool>> ready;
+    };
+
+public:
+    using value_type = T;
+
+    ConcurrentVector() = default;
+
+    ConcurrentVector(const ConcurrentVector&) = delete;
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+    ~ConcurrentVector() {
+        Clear();
+        for (std::atomic<Segment*>& segment : segments_) {
+            delete segment.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Число зарезервированных слотов. Часть из них может быть ещё не опубликована
+    size_t Size() const noexcept {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    // Опубликован ли элемент index. После true элемент можно читать через operator[]
+    bool IsReady(size_t index) const noexcept {
+        if (index >= Size()) {
+            return false;
+        }
+        const size_t segment = Layout::SegmentOf(index);
+        const Segment* data = segments_[segment].load(std::memory_order_acquire);
+        return data != nullptr
+               && data->ready.GetAddress()[Layout::OffsetIn(index, segment)].load(std::memory_order_acquire);
+    }
+
+    // Доступ к опубликованному элементу. Его публикация должна быть видна вызывающему потоку
+    // (через IsReady или иную синхронизацию)
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<ConcurrentVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(IsReady(index));
+        const size_t segment = Layout::SegmentOf(index);
+        Segment* data = segments_[segment].load(std::memory_order_acquire);
+        return data->elements.GetAddress()[Layout::OffsetIn(index, segment)];
+    }
+
+    // Резервирует слот одним fetch_add и конструирует в нём элемент. Если конструктор
+    // выбросит исключение, слот остаётся неопубликованным
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        const size_t index = size_.fetch_add(1, std::memory_order_relaxed);
+        return Publish(index, std::forward<Args>(args)...);
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    // Резервирует n подряд идущих слотов за один fetch_add и заполняет их значениями по умолчанию.
+    // Возвращает индекс первого из них
+    size_t GrowBy(size_t n) {
+        const size_t first = size_.fetch_add(n, std::memory_order_relaxed);
+        for (size_t i = first; i != first + n; ++i) {
+            Publish(i);
+        }
+        return first;
+    }
+
+    // Вызывает f(element) для опубликованных элементов по порядку
+    template <typename F>
+    void ForEach(F f) {
+        const size_t size = Size();
+        for (size_t i = 0; i != size; ++i) {
+            if (IsReady(i)) {
+                f((*this)[i]);
+            }
+        }
+    }
+
+    // Разрушает элементы, сохраняя выделенные сегменты
+    void Clear() noexcept {
+        ForEach([](T& value) {
+            std::destroy_at(&value);
+        });
+        for (size_t segment = 0; segment != kMaxSegments; ++segment) {
+            Segment* data = segments_[segment].load(std::memory_order_relaxed);
+            if (data == nullptr) {
+                continue;
+            }
+            std::atomic<bool>* ready = data->ready.GetAddress();
+            for (size_t i = 0; i != Layout::SegmentCapacity(segment); ++i) {
+                ready[i].store(false, std::memory_order_relaxed);
+            }
+        }
+        size_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    template <typename... Args>
+    T& Publish(size_t index, Args&&... args) {
+        const size_t segment = Layout::SegmentOf(index);
+        assert(segment < kMaxSegments);
+        Segment& data = *SegmentAt(segment);
+        const size_t offset = Layout::OffsetIn(index, segment);
+        T* value = new (data.elements.GetAddress() + offset) T(std::forward<Args>(args)...);
+        data.ready.GetAddress()[offset].store(true, std::memory_order_release);
+        return *value;
+    }
+
+    Segment* SegmentAt(size_t segment) {
+        Segment* data = segments_[segment].load(std::memory_order_acquire);
+        return data != nullptr ? data : AllocateSegment(segment);
+    }
+
+    // Выделяет сегмент и публикует его через CAS. Кандидат проигравшего гонку потока освобождается
+    Segment* AllocateSegment(size_t segment) {
+        auto candidate = std::make_unique<Segment>(Layout::SegmentCapacity(segment));
+        Segment* expected = nullptr;
+        if (segments_[segment].compare_exchange_strong(expected, candidate.get(), std::memory_order_acq_rel,
+                                                       std::memory_order_acquire)) {
+            return candidate.release();
+        }
+        return expected;
+    }
+
+    alignas(kCacheLine) std::atomic<size_t> size_{0};
+    alignas(kCacheLine) std::atomic<Segment*> segments_[kMaxSegments] = {};
+};
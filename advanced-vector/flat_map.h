@@ -0,0 +1,526 @@
+#pragma once
+#include "views.h"
+
+#include <functional>
+#include <stdexcept>
+
+// Упорядоченные ассоциативные контейнеры поверх Vector: ключи хранятся отсортированными
+// в одном непрерывном буфере, значения FlatMap - в отдельном векторе с теми же индексами.
+// Поиск читает только ключи, без перехода по узлам, поэтому таблицы, в которых поиск
+// намного чаще изменений, работают быстрее std::map. Вставка и удаление одного ключа
+// сдвигают хвост за O(n); много ключей сразу вставляет InsertSorted.
+// Итераторы и указатели становятся недействительными после любого изменения состава ключей
+
+namespace detail {
+
+// Бинарный поиск первого ключа, не меньшего key, без ветвлений: число итераций зависит
+// только от n, и процессору нечего предсказывать
+template <typename Key, typename K, typename Compare>
+size_t FlatLowerBound(const Key* keys, size_t n, const K& key, const Compare& comp) {
+    if (n == 0) {
+        return 0;
+    }
+    const Key* base = keys;
+    while (n > 1) {
+        const size_t half = n / 2;
+        // Умножение вместо тернарного оператора: его компилятор может превратить в условный переход
+        base += static_cast<size_t>(comp(base[half - 1], key)) * half;
+        n -= half;
+    }
+    return static_cast<size_t>(base - keys) + (comp(*base, key) ? 1 : 0);
+}
+
+// Сортирует pending и оставляет по одному элементу с каждым ключом - первый среди равных
+template <typename T, typename... Params, typename KeyOf, typename Compare>
+void SortUnique(Vector<T, Params...>& pending, KeyOf key_of, const Compare& comp) {
+    std::stable_sort(pending.begin(), pending.end(), [&](const T& lhs, const T& rhs) {
+        return comp(key_of(lhs), key_of(rhs));
+    });
+    const auto last = std::unique(pending.begin(), pending.end(), [&](const T& lhs, const T& rhs) {
+        return !comp(key_of(lhs), key_of(rhs));
+    });
+    pending.Erase(last, pending.end());
+}
+
+inline constexpr size_t kMergeDuplicate = std::numeric_limits<size_t>::max();
+
+// Для каждого элемента отсортированного pending находит индекс ключа keys, перед которым он
+// встанет, или kMergeDuplicate, если такой ключ уже есть. Слияние выполняет все сравнения
+// здесь, до переноса элементов: исключение из comp не должно застать keys частично перемещённым
+template <typename Key, typename... KeyParams, typename T, typename... Params, typename KeyOf, typename Compare>
+Vector<size_t> MergePositions(const Vector<Key, KeyParams...>& keys, const Vector<T, Params...>& pending,
+                              KeyOf key_of, const Compare& comp) {
+    Vector<size_t> positions(pending.Size());
+    size_t i = 0;
+    for (size_t j = 0; j < pending.Size(); ++j) {
+        while (i < keys.Size() && comp(keys[i], key_of(pending[j]))) {
+            ++i;
+        }
+        positions[j] = i < keys.Size() && !comp(key_of(pending[j]), keys[i]) ? kMergeDuplicate : i;
+    }
+    return positions;
+}
+
+}  // namespace detail
+
+template <typename Key, typename Compare = std::less<Key>>
+class FlatSet {
+public:
+    using key_type = Key;
+    using value_type = Key;
+    using iterator = const Key*;
+    using const_iterator = const Key*;
+
+    FlatSet() = default;
+
+    explicit FlatSet(const Compare& comp)
+        : comp_(comp) {
+    }
+
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    FlatSet(InputIt first, InputIt last, const Compare& comp = Compare())
+        : comp_(comp) {
+        InsertSorted(first, last);
+    }
+
+    FlatSet(std::initializer_list<Key> keys, const Compare& comp = Compare())
+        : FlatSet(keys.begin(), keys.end(), comp) {
+    }
+
+    size_t Size() const noexcept {
+        return keys_.Size();
+    }
+
+    bool Empty() const noexcept {
+        return keys_.Size() == 0;
+    }
+
+    size_t Capacity() const noexcept {
+        return keys_.Capacity();
+    }
+
+    void Reserve(size_t new_capacity) {
+        keys_.Reserve(new_capacity);
+    }
+
+    // Ключи в порядке возрастания
+    const Vector<Key>& Keys() const noexcept {
+        return keys_;
+    }
+
+    const Key* Data() const noexcept {
+        return keys_.Data();
+    }
+
+    const_iterator begin() const noexcept {
+        return keys_.Data();
+    }
+    const_iterator end() const noexcept {
+        return keys_.Data() + keys_.Size();
+    }
+
+    const Key& operator[](size_t index) const noexcept {
+        return keys_[index];
+    }
+
+    // Позиция первого ключа, не меньшего key
+    size_t LowerBound(const Key& key) const {
+        return detail::FlatLowerBound(keys_.Data(), keys_.Size(), key, comp_);
+    }
+
+    // Позиция ключа или Size(), если его нет
+    size_t IndexOf(const Key& key) const {
+        const size_t index = LowerBound(key);
+        return index != keys_.Size() && !comp_(key, keys_[index]) ? index : keys_.Size();
+    }
+
+    const_iterator Find(const Key& key) const {
+        return begin() + IndexOf(key);
+    }
+
+    bool Contains(const Key& key) const {
+        return IndexOf(key) != keys_.Size();
+    }
+
+    size_t Count(const Key& key) const {
+        return Contains(key) ? 1 : 0;
+    }
+
+    // Возвращает позицию ключа и признак того, что он был вставлен
+    std::pair<const_iterator, bool> Insert(const Key& key) {
+        return Emplace(key);
+    }
+
+    std::pair<const_iterator, bool> Insert(Key&& key) {
+        return Emplace(std::move(key));
+    }
+
+    template <typename... Args>
+    std::pair<const_iterator, bool> Emplace(Args&&... args) {
+        Key key(std::forward<Args>(args)...);
+        const size_t index = LowerBound(key);
+        if (index != keys_.Size() && !comp_(key, keys_[index])) {
+            return {begin() + index, false};
+        }
+        keys_.Emplace(keys_.begin() + index, std::move(key));
+        return {begin() + index, true};
+    }
+
+    // Вставляет ключи [first, last) в любом порядке; уже имеющиеся ключи пропускаются.
+    // Новые ключи копируются в конец одним Append, сортируются и сливаются с прежними
+    // за один проход с одним выделением памяти. Если все новые ключи больше прежних,
+    // слияние не нужно и ключи остаются на месте. Исключение при слиянии оставляет множество
+    // прежним: старые ключи перемещаются, только если перемещение не выбрасывает исключений,
+    // иначе копируются
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    void InsertSorted(InputIt first, InputIt last) {
+        Vector<Key> pending;
+        pending.Append(first, last);
+        if (pending.Size() == 0) {
+            return;
+        }
+        detail::SortUnique(pending, KeyOf{}, comp_);
+        if (keys_.Size() == 0 || comp_(keys_[keys_.Size() - 1], pending[0])) {
+            keys_.Append(std::make_move_iterator(pending.begin()), std::make_move_iterator(pending.end()));
+            return;
+        }
+        const Vector<size_t> positions = detail::MergePositions(keys_, pending, KeyOf{}, comp_);
+        Vector<Key> merged;
+        merged.Reserve(keys_.Size() + pending.Size());
+        size_t i = 0;
+        for (size_t j = 0; j < pending.Size(); ++j) {
+            if (positions[j] == detail::kMergeDuplicate) {
+                continue;
+            }
+            for (; i < positions[j]; ++i) {
+                merged.EmplaceBack(std::move_if_noexcept(keys_[i]));
+            }
+            merged.EmplaceBack(std::move(pending[j]));
+        }
+        for (; i < keys_.Size(); ++i) {
+            merged.EmplaceBack(std::move_if_noexcept(keys_[i]));
+        }
+        keys_.Swap(merged);
+    }
+
+    template <typename Range>
+    void InsertSorted(const Range& range) {
+        InsertSorted(std::begin(range), std::end(range));
+    }
+
+    // Возвращает количество удалённых ключей
+    size_t Erase(const Key& key) {
+        const size_t index = IndexOf(key);
+        if (index == keys_.Size()) {
+            return 0;
+        }
+        keys_.Erase(keys_.begin() + index);
+        return 1;
+    }
+
+    const_iterator Erase(const_iterator pos) {
+        const size_t idx = pos - keys_.Data();
+        keys_.Erase(keys_.begin() + idx);
+        return keys_.Data() + idx;
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+    }
+
+    void Swap(FlatSet& other) noexcept(std::is_nothrow_swappable_v<Compare>) {
+        keys_.Swap(other.keys_);
+        std::swap(comp_, other.comp_);
+    }
+
+    friend bool operator==(const FlatSet& lhs, const FlatSet& rhs) {
+        return lhs.keys_ == rhs.keys_;
+    }
+
+    friend bool operator!=(const FlatSet& lhs, const FlatSet& rhs) {
+        return !(lhs == rhs);
+    }
+
+private:
+    struct KeyOf {
+        const Key& operator()(const Key& key) const noexcept {
+            return key;
+        }
+    };
+
+    Vector<Key> keys_;
+    Compare comp_;
+};
+
+template <typename Key, typename Value, typename Compare = std::less<Key>>
+class FlatMap {
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = std::pair<Key, Value>;
+
+    FlatMap() = default;
+
+    explicit FlatMap(const Compare& comp)
+        : comp_(comp) {
+    }
+
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    FlatMap(InputIt first, InputIt last, const Compare& comp = Compare())
+        : comp_(comp) {
+        InsertSorted(first, last);
+    }
+
+    FlatMap(std::initializer_list<value_type> items, const Compare& comp = Compare())
+        : FlatMap(items.begin(), items.end(), comp) {
+    }
+
+    size_t Size() const noexcept {
+        return keys_.Size();
+    }
+
+    bool Empty() const noexcept {
+        return keys_.Size() == 0;
+    }
+
+    size_t Capacity() const noexcept {
+        return std::min(keys_.Capacity(), values_.Capacity());
+    }
+
+    void Reserve(size_t new_capacity) {
+        keys_.Reserve(new_capacity);
+        values_.Reserve(new_capacity);
+    }
+
+    // Ключи в порядке возрастания; значение ключа Keys()[i] - Values()[i]
+    const Vector<Key>& Keys() const noexcept {
+        return keys_;
+    }
+
+    VectorView<Value> Values() noexcept {
+        return values_;
+    }
+
+    VectorView<const Value> Values() const noexcept {
+        return values_;
+    }
+
+    const Key& KeyAt(size_t index) const noexcept {
+        return keys_[index];
+    }
+
+    Value& ValueAt(size_t index) noexcept {
+        return values_[index];
+    }
+
+    const Value& ValueAt(size_t index) const noexcept {
+        return values_[index];
+    }
+
+    // Позиция первого ключа, не меньшего key
+    size_t LowerBound(const Key& key) const {
+        return detail::FlatLowerBound(keys_.Data(), keys_.Size(), key, comp_);
+    }
+
+    // Позиция ключа или Size(), если его нет
+    size_t IndexOf(const Key& key) const {
+        const size_t index = LowerBound(key);
+        return index != keys_.Size() && !comp_(key, keys_[index]) ? index : keys_.Size();
+    }
+
+    // Указатель на значение ключа или nullptr
+    Value* Find(const Key& key) {
+        const size_t index = IndexOf(key);
+        return index != keys_.Size() ? &values_[index] : nullptr;
+    }
+
+    const Value* Find(const Key& key) const {
+        return const_cast<FlatMap&>(*this).Find(key);
+    }
+
+    bool Contains(const Key& key) const {
+        return IndexOf(key) != keys_.Size();
+    }
+
+    size_t Count(const Key& key) const {
+        return Contains(key) ? 1 : 0;
+    }
+
+    Value& At(const Key& key) {
+        Value* value = Find(key);
+        if (value == nullptr) {
+            throw std::out_of_range("FlatMap::At: no such key");
+        }
+        return *value;
+    }
+
+    const Value& At(const Key& key) const {
+        return const_cast<FlatMap&>(*this).At(key);
+    }
+
+    // Значение ключа; отсутствующий ключ вставляется со значением по умолчанию
+    Value& operator[](const Key& key) {
+        return *TryEmplace(key).first;
+    }
+
+    Value& operator[](Key&& key) {
+        return *TryEmplace(std::move(key)).first;
+    }
+
+    // Вставляет ключ со значением из args, если ключа ещё нет. Возвращает указатель
+    // на значение ключа и признак вставки
+    template <typename K, typename... Args>
+    std::pair<Value*, bool> TryEmplace(K&& key, Args&&... args) {
+        const size_t index = LowerBound(key);
+        if (index != keys_.Size() && !comp_(key, keys_[index])) {
+            return {&values_[index], false};
+        }
+        values_.Emplace(values_.begin() + index, std::forward<Args>(args)...);
+        try {
+            keys_.Emplace(keys_.begin() + index, std::forward<K>(key));
+        } catch (...) {
+            values_.Erase(values_.begin() + index);
+            throw;
+        }
+        return {&values_[index], true};
+    }
+
+    std::pair<Value*, bool> Insert(const value_type& item) {
+        return TryEmplace(item.first, item.second);
+    }
+
+    std::pair<Value*, bool> Insert(value_type&& item) {
+        return TryEmplace(std::move(item.first), std::move(item.second));
+    }
+
+    template <typename K, typename V>
+    std::pair<Value*, bool> InsertOrAssign(K&& key, V&& value) {
+        auto [slot, inserted] = TryEmplace(std::forward<K>(key), std::forward<V>(value));
+        if (!inserted) {
+            *slot = std::forward<V>(value);
+        }
+        return {slot, inserted};
+    }
+
+    // Вставляет пары [first, last) в любом порядке. Как у std::map::insert, значения уже
+    // имеющихся ключей не меняются, а из равных новых ключей берётся первый.
+    // Пары собираются одним Append, сортируются и сливаются с прежними за один проход.
+    // Исключение при слиянии оставляет словарь прежним: старые пары копируются, если перемещение
+    // ключа или значения может выбросить исключение
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    void InsertSorted(InputIt first, InputIt last) {
+        Vector<value_type> pending;
+        pending.Append(first, last);
+        if (pending.Size() == 0) {
+            return;
+        }
+        detail::SortUnique(pending, PairKey{}, comp_);
+        if (keys_.Size() == 0 || comp_(keys_[keys_.Size() - 1], pending[0].first)) {
+            AppendPending(pending, 0);
+            return;
+        }
+        const Vector<size_t> positions = detail::MergePositions(keys_, pending, PairKey{}, comp_);
+        FlatMap merged(comp_);
+        merged.Reserve(keys_.Size() + pending.Size());
+        size_t i = 0;
+        for (size_t j = 0; j < pending.Size(); ++j) {
+            if (positions[j] == detail::kMergeDuplicate) {
+                continue;
+            }
+            for (; i < positions[j]; ++i) {
+                merged.EmplaceBackUnchecked(TakeOld(keys_[i]), TakeOld(values_[i]));
+            }
+            merged.EmplaceBackUnchecked(std::move(pending[j].first), std::move(pending[j].second));
+        }
+        for (; i < keys_.Size(); ++i) {
+            merged.EmplaceBackUnchecked(TakeOld(keys_[i]), TakeOld(values_[i]));
+        }
+        Swap(merged);
+    }
+
+    template <typename Range>
+    void InsertSorted(const Range& range) {
+        InsertSorted(std::begin(range), std::end(range));
+    }
+
+    // Возвращает количество удалённых ключей
+    size_t Erase(const Key& key) {
+        const size_t index = IndexOf(key);
+        if (index == keys_.Size()) {
+            return 0;
+        }
+        EraseAt(index);
+        return 1;
+    }
+
+    void EraseAt(size_t index) {
+        assert(index < keys_.Size());
+        keys_.Erase(keys_.begin() + index);
+        values_.Erase(values_.begin() + index);
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+        values_.Clear();
+    }
+
+    void Swap(FlatMap& other) noexcept(std::is_nothrow_swappable_v<Compare>) {
+        keys_.Swap(other.keys_);
+        values_.Swap(other.values_);
+        std::swap(comp_, other.comp_);
+    }
+
+    friend bool operator==(const FlatMap& lhs, const FlatMap& rhs) {
+        return lhs.keys_ == rhs.keys_ && lhs.values_ == rhs.values_;
+    }
+
+    friend bool operator!=(const FlatMap& lhs, const FlatMap& rhs) {
+        return !(lhs == rhs);
+    }
+
+private:
+    struct PairKey {
+        const Key& operator()(const value_type& item) const noexcept {
+            return item.first;
+        }
+    };
+
+    // Старые пары при слиянии перемещаются, только если не выбрасывают исключений ни ключ, ни значение:
+    // иначе исключение второго оставило бы в словаре перемещённый первый
+    static constexpr bool kMoveOldPairs =
+        (std::is_nothrow_move_constructible_v<Key> && std::is_nothrow_move_constructible_v<Value>)
+        || !std::is_copy_constructible_v<Key> || !std::is_copy_constructible_v<Value>;
+
+    template <typename U>
+    static decltype(auto) TakeOld(U& item) noexcept {
+        if constexpr (kMoveOldPairs) {
+            return std::move(item);
+        } else {
+            return std::as_const(item);
+        }
+    }
+
+    // Добавляет пару в конец; ключ должен быть больше всех имеющихся, а память - зарезервирована
+    // для обоих векторов, иначе сбой может оставить ключ без значения
+    template <typename K, typename V>
+    void EmplaceBackUnchecked(K&& key, V&& value) {
+        values_.EmplaceBack(std::forward<V>(value));
+        try {
+            keys_.EmplaceBack(std::forward<K>(key));
+        } catch (...) {
+            values_.PopBack();
+            throw;
+        }
+    }
+
+    void AppendPending(Vector<value_type>& pending, size_t from) {
+        Reserve(keys_.Size() + pending.Size() - from);
+        for (size_t j = from; j < pending.Size(); ++j) {
+            EmplaceBackUnchecked(std::move(pending[j].first), std::move(pending[j].second));
+        }
+    }
+
+    Vector<Key> keys_;
+    Vector<Value> values_;
+    Compare comp_;
+};
@@ -0,0 +1,150 @@
+// Проверка гарантий InsertSorted: исключение из сравнения или копирования ключа на любом шаге
+// слияния оставляет FlatSet и FlatMap прежними.
+//
+// Сборка и запуск: g++ -std=c++17 -Wall -Wextra flat_map_test.cpp -o flat_map_test && ./flat_map_test
+#include "flat_map.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+#define CHECK(cond)                                                                     \
+    do {                                                                                \
+        if (!(cond)) {                                                                  \
+            std::fprintf(stderr, "%s:%d: %s failed (step %d)\n", __FILE__, __LINE__, #cond, step); \
+            std::abort();                                                               \
+        }                                                                               \
+    } while (false)
+
+namespace {
+
+// Сколько ещё операций выполнится до исключения
+int budget = 0;
+
+void Spend() {
+    if (--budget < 0) {
+        throw 0;
+    }
+}
+
+// Ключ, копирование которого выбрасывает исключение, а перемещение не помечено noexcept
+struct ThrowingKey {
+    explicit ThrowingKey(std::string v)
+        : value(std::move(v)) {
+    }
+
+    ThrowingKey(const ThrowingKey& other)
+        : value(other.value) {
+        Spend();
+    }
+
+    ThrowingKey(ThrowingKey&& other)
+        : value(std::move(other.value)) {
+        Spend();
+    }
+
+    ThrowingKey& operator=(const ThrowingKey&) = default;
+    ThrowingKey& operator=(ThrowingKey&&) = default;
+
+    bool operator<(const ThrowingKey& rhs) const {
+        return value < rhs.value;
+    }
+
+    std::string value;
+};
+
+struct ThrowingLess {
+    bool operator()(const std::string& lhs, const std::string& rhs) const {
+        Spend();
+        return lhs < rhs;
+    }
+};
+
+constexpr int kUnlimited = 1 << 30;
+
+const char* const kOld[] = {"b", "d", "f", "h", "j"};
+const char* const kNew[] = {"a", "c", "d", "k", "e", "d"};
+
+void CheckSetComparator() {
+    for (int step = 0; step < 100; ++step) {
+        budget = kUnlimited;
+        FlatSet<std::string, ThrowingLess> set(std::begin(kOld), std::end(kOld));
+        budget = step;
+        bool thrown = false;
+        try {
+            set.InsertSorted(std::begin(kNew), std::end(kNew));
+        } catch (int) {
+            thrown = true;
+        }
+        budget = kUnlimited;
+        CHECK(set.Size() == (thrown ? 5 : 9));
+        CHECK(std::is_sorted(set.begin(), set.end()));
+        for (const char* key : kOld) {
+            CHECK(set.Contains(key));
+        }
+    }
+}
+
+void CheckMapThrowingKey() {
+    for (int step = 0; step < 100; ++step) {
+        budget = kUnlimited;
+        FlatMap<ThrowingKey, std::string> map;
+        for (const char* key : kOld) {
+            map.TryEmplace(ThrowingKey(key), std::string(key) + " value");
+        }
+        Vector<std::pair<ThrowingKey, std::string>> items;
+        for (const char* key : kNew) {
+            items.EmplaceBack(ThrowingKey(key), "new");
+        }
+        budget = step;
+        bool thrown = false;
+        try {
+            map.InsertSorted(items);
+        } catch (int) {
+            thrown = true;
+        }
+        budget = kUnlimited;
+        CHECK(map.Size() == (thrown ? 5 : 9));
+        for (const char* key : kOld) {
+            // Значения прежних ключей не должны оказаться перемещёнными
+            CHECK(map.At(ThrowingKey(key)) == std::string(key) + " value");
+        }
+        if (!thrown) {
+            CHECK(map.At(ThrowingKey("a")) == "new");
+        }
+    }
+}
+
+void CheckMapComparator() {
+    for (int step = 0; step < 100; ++step) {
+        budget = kUnlimited;
+        FlatMap<std::string, std::string, ThrowingLess> map;
+        for (const char* key : kOld) {
+            map.TryEmplace(key, std::string(key) + " value");
+        }
+        const std::pair<std::string, std::string> items[] = {{"a", "1"}, {"k", "2"}, {"d", "3"}, {"c", "4"}};
+        budget = step;
+        bool thrown = false;
+        try {
+            map.InsertSorted(std::begin(items), std::end(items));
+        } catch (int) {
+            thrown = true;
+        }
+        budget = kUnlimited;
+        CHECK(map.Size() == (thrown ? 5 : 8));
+        for (const char* key : kOld) {
+            CHECK(map.At(key) == std::string(key) + " value");
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    CheckSetComparator();
+    CheckMapThrowingKey();
+    CheckMapComparator();
+    std::puts("flat map test passed");
+}
@@ -0,0 +1,178 @@
+// Проверка защищённого режима: вызывает все методы контейнеров, принимающие или возвращающие
+// итераторы, с итераторами Vector в виде CheckedIterator. Ошибка компиляции здесь означает, что
+// какой-то заголовок снова передаёт в Vector указатель вместо итератора.
+//
+// Сборка и запуск: g++ -std=c++17 -Wall -Wextra hardened_check.cpp -o hardened_check && ./hardened_check
+#define ADVANCED_VECTOR_HARDENED 1
+
+#include "byte_io.h"
+#include "flat_map.h"
+#include "serialization.h"
+#include "shared_vector.h"
+#include "small_vector.h"
+#include "static_vector.h"
+#include "vector.h"
+#include "views.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <initializer_list>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            std::fprintf(stderr, "%s:%d: %s failed\n", __FILE__, __LINE__, #cond); \
+            std::abort();                                                    \
+        }                                                                    \
+    } while (false)
+
+static_assert(!std::is_pointer_v<Vector<int>::iterator>, "hardened Vector must use checked iterators");
+
+namespace {
+
+void CheckVector() {
+    const int values[] = {5, 1, 4, 2, 3};
+    Vector<int> vec(std::begin(values), std::end(values));
+    vec.Insert(vec.begin(), 0);
+    vec.Insert(vec.cend(), 9);
+    vec.Insert(vec.begin() + 1, std::begin(values), std::end(values));
+    vec.Insert(vec.begin(), 2, 7);
+    vec.Emplace(vec.cbegin() + 3, 8);
+    vec.Erase(vec.begin());
+    vec.Erase(vec.cbegin(), vec.cbegin() + 2);
+    vec.SwapRemove(vec.begin());
+    vec.Append(std::begin(values), std::end(values));
+    std::sort(vec.begin(), vec.end());
+    CHECK(std::is_sorted(vec.cbegin(), vec.cend()));
+    EraseIf(vec, [](int x) { return x > 4; });
+    vec.Assign(std::begin(values), std::end(values));
+    Vector<int>::const_iterator it = vec.begin();
+    CHECK(it == vec.cbegin() && it[1] == 1 && *(vec.end() - 1) == 3);
+    CHECK(std::accumulate(vec.begin(), vec.end(), 0) == 15);
+
+    Vector<std::string> strings;
+    strings.PushBack("b");
+    strings.Emplace(strings.begin(), "a");
+    strings.Insert(strings.end(), std::string("c"));
+    CHECK(strings.Size() == 3 && strings.begin()->size() == 1);
+}
+
+Vector<int> MakeVector(std::initializer_list<int> values) {
+    return Vector<int>(values.begin(), values.end());
+}
+
+// Итераторы следуют за буфером при перемещении и обмене, как у std::vector
+void CheckIteratorsFollowBuffer() {
+    Vector<int> a = MakeVector({1, 2, 3});
+    Vector<int> b = MakeVector({4, 5});
+    Vector<int>::iterator in_a = a.begin() + 1;
+    Vector<int>::const_iterator in_b = b.cbegin();
+    a.Swap(b);
+    CHECK(*in_a == 2 && *in_b == 4);
+    CHECK(in_a - b.begin() == 1 && in_b == a.cbegin());
+    b.Erase(in_a);
+    CHECK(b.Size() == 2 && b[1] == 3);
+
+    Vector<int> moved(std::move(a));
+    CHECK(*in_b == 4 && in_b == moved.cbegin());
+    moved.Insert(in_b, 0);
+    CHECK(moved.Size() == 3 && moved[0] == 0);
+
+    Vector<int>::iterator in_b_buffer = b.begin();
+    Vector<int> assigned;
+    assigned = std::move(b);
+    CHECK(*in_b_buffer == 1 && in_b_buffer == assigned.begin());
+
+    using std::swap;
+    Vector<std::string> x(2, "x");
+    Vector<std::string> y(1, "y");
+    Vector<std::string>::iterator in_x = x.end() - 1;
+    swap(x, y);
+    CHECK(*in_x == "x" && in_x + 1 == y.end());
+
+    // Итераторы, созданные конструктором по умолчанию, равны между собой
+    Vector<int>::iterator none;
+    Vector<int>::const_iterator also_none;
+    CHECK(none == also_none && !(none != also_none) && none - also_none == 0 && !(none < also_none));
+}
+
+void CheckSmallAndStatic() {
+    SmallVector<int, 4> small;
+    small.PushBack(1);
+    small.Insert(small.begin(), 0);
+    small.Emplace(small.end(), 2);
+    small.Erase(small.begin());
+    CHECK(small.Size() == 2);
+
+    StaticVector<int, 8> fixed{3, 1, 2};
+    fixed.Insert(fixed.begin(), 0);
+    fixed.Emplace(fixed.end(), 4);
+    fixed.Erase(fixed.begin(), fixed.begin() + 1);
+    fixed.Erase(fixed.begin());
+    CHECK(fixed.Size() == 3);
+}
+
+void CheckShared() {
+    SharedVector<int> shared;
+    shared.PushBack(1);
+    shared.PushBack(3);
+    SharedVector<int> snapshot = shared.Snapshot();
+    SharedVector<int>::iterator it = shared.Insert(shared.begin() + 1, 2);
+    CHECK(*it == 2);
+    it = shared.Emplace(shared.begin(), 0);
+    *it = -1;
+    it = shared.Erase(shared.begin());
+    CHECK(*it == 1);
+    shared.Erase(shared.begin(), shared.begin() + 1);
+    CHECK(shared.Size() == 2 && snapshot.Size() == 2);
+}
+
+void CheckFlat() {
+    const int keys[] = {4, 2, 8, 2};
+    FlatSet<int> set(std::begin(keys), std::end(keys));
+    set.InsertSorted(std::begin(keys), std::end(keys));
+    set.Insert(6);
+    set.Erase(set.begin());
+    set.Erase(8);
+    CHECK(set.Size() == 2 && set.Find(4) != set.end());
+
+    const std::pair<int, std::string> items[] = {{2, "b"}, {1, "a"}};
+    FlatMap<int, std::string> map(std::begin(items), std::end(items));
+    map.InsertSorted(std::begin(items), std::end(items));
+    map.TryEmplace(3, "c");
+    map.Erase(1);
+    CHECK(map.Size() == 2 && map.At(3) == "c");
+}
+
+void CheckViewsAndIo() {
+    Vector<int> vec(16);
+    std::iota(vec.begin(), vec.end(), 0);
+    VectorView view(vec);
+    CHECK(view.Size() == 16 && view.Subview(2, 3)[0] == 2);
+
+    std::stringstream stream;
+    Save(stream, vec);
+    Vector<int> loaded;
+    Load(stream, loaded);
+    CHECK(loaded == vec);
+
+    std::istringstream bytes("payload");
+    Vector<char> buf;
+    CHECK(AppendFrom(bytes, buf) == 7 && *buf.begin() == 'p');
+}
+
+}  // namespace
+
+int main() {
+    CheckVector();
+    CheckIteratorsFollowBuffer();
+    CheckSmallAndStatic();
+    CheckShared();
+    CheckFlat();
+    CheckViewsAndIo();
+    std::puts("hardened check passed");
+}
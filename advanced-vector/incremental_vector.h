@@ -0,0 +1,239 @@
+#pragma once
+#include "vector.h"
+
+// Вектор с растянутым во времени перевыделением памяти. Когда размер достигает вместимости,
+// выделяется новый буфер, но элементы переносятся в него не сразу, а порциями при каждом
+// следующем EmplaceBack (как инкрементальный рехеш в Redis). Поэтому худшее время одной
+// операции не зависит от размера вектора. Пока перенос не завершён, элементы
+// [migrated_, old_size_) лежат в старом буфере, остальные - в новом
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth>
+class IncrementalVector {
+    using Memory = RawMemory<T, Alloc>;
+
+    static constexpr bool kRelocateBytes = kIsTriviallyRelocatable<T>;
+
+    // Минимальное число элементов, переносимых за одну операцию
+    static constexpr size_t kMinMigrationStep = 2;
+
+public:
+    using value_type = T;
+    using allocator_type = Alloc;
+
+    IncrementalVector() = default;
+
+    explicit IncrementalVector(const Alloc& alloc)
+        : data_(alloc)
+        , old_data_(alloc) {
+    }
+
+    IncrementalVector(const IncrementalVector& other)
+        : data_(other.size_, std::allocator_traits<Alloc>::select_on_container_copy_construction(other.GetAllocator()))
+        , old_data_(data_.GetAllocator()) {
+        for (; size_ != other.size_; ++size_) {
+            try {
+                new (data_ + size_) T(other[size_]);
+            } catch (...) {
+                std::destroy_n(data_.GetAddress(), size_);
+                throw;
+            }
+        }
+    }
+
+    IncrementalVector(IncrementalVector&& other) noexcept
+        : data_(std::move(other.data_))
+        , old_data_(std::move(other.old_data_))
+        , size_(std::exchange(other.size_, 0))
+        , old_size_(std::exchange(other.old_size_, 0))
+        , migrated_(std::exchange(other.migrated_, 0))
+        , step_(std::exchange(other.step_, kMinMigrationStep)) {
+    }
+
+    ~IncrementalVector() {
+        DestroyAll();
+    }
+
+    IncrementalVector& operator=(const IncrementalVector& rhs) {
+        if (this != &rhs) {
+            IncrementalVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    IncrementalVector& operator=(IncrementalVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Swap(rhs);
+        }
+        return *this;
+    }
+
+    void Swap(IncrementalVector& other) noexcept {
+        data_.Swap(other.data_);
+        old_data_.Swap(other.old_data_);
+        std::swap(size_, other.size_);
+        std::swap(old_size_, other.old_size_);
+        std::swap(migrated_, other.migrated_);
+        std::swap(step_, other.step_);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return data_.Capacity();
+    }
+
+    const Alloc& GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+    // Идёт ли перенос элементов из старого буфера
+    bool IsMigrating() const noexcept {
+        return migrated_ != old_size_;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<IncrementalVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return index - migrated_ < old_size_ - migrated_ ? old_data_[index] : data_[index];
+    }
+
+    // Непрерывный буфер элементов. Доступен только после завершения переноса
+    T* Data() noexcept {
+        assert(!IsMigrating());
+        return data_.GetAddress();
+    }
+
+    const T* Data() const noexcept {
+        return const_cast<IncrementalVector&>(*this).Data();
+    }
+
+    // Переносит все оставшиеся элементы в новый буфер и освобождает старый
+    void FinishMigration() {
+        if (IsMigrating()) {
+            Migrate(old_size_ - migrated_);
+        }
+    }
+
+    // Резервирует память сразу, без растягивания переноса во времени
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+        FinishMigration();
+        StartMigration(new_capacity);
+        FinishMigration();
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    // Выделение нового буфера не трогает элементы, поэтому args может ссылаться на элемент вектора:
+    // новый элемент конструируется до переноса очередной порции
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            // Шаг переноса выбирается так, чтобы перенос завершился раньше, чем заполнится новый буфер
+            assert(!IsMigrating());
+            FinishMigration();
+            StartMigration(Growth::NextCapacity(Capacity(), size_ + 1, sizeof(T)));
+        }
+        T* slot = new (data_ + size_) T(std::forward<Args>(args)...);
+        ++size_;
+        if (IsMigrating()) {
+            try {
+                Migrate(std::min(step_, old_size_ - migrated_));
+            } catch (...) {
+                std::destroy_at(slot);
+                --size_;
+                throw;
+            }
+        }
+        return *slot;
+    }
+
+    void PopBack() {
+        if (size_ == 0) {
+            return;
+        }
+        --size_;
+        if (size_ < old_size_ && size_ >= migrated_) {
+            std::destroy_at(old_data_ + size_);
+            old_size_ = size_;
+            if (!IsMigrating()) {
+                ReleaseOldData();
+            }
+        } else {
+            std::destroy_at(data_ + size_);
+        }
+    }
+
+    // Разрушает элементы и освобождает старый буфер, сохраняя вместимость нового
+    void Clear() noexcept {
+        DestroyAll();
+        size_ = 0;
+        ReleaseOldData();
+    }
+
+private:
+    // Делает текущий буфер старым и выделяет новый. Элементы остаются на месте
+    void StartMigration(size_t new_capacity) {
+        Memory new_data(new_capacity, GetAllocator());
+        data_.Swap(new_data);
+        old_data_.Swap(new_data);
+        old_size_ = size_;
+        migrated_ = 0;
+        const size_t free_slots = new_capacity - old_size_;
+        step_ = std::max(kMinMigrationStep, (old_size_ + free_slots - 1) / free_slots);
+        if (!IsMigrating()) {
+            ReleaseOldData();
+        }
+    }
+
+    // Переносит count очередных элементов. Если перенос элемента выбросит исключение,
+    // уже перенесённые остаются в новом буфере, а вектор - в согласованном состоянии
+    void Migrate(size_t count) {
+        const size_t last = migrated_ + count;
+        if constexpr (kRelocateBytes) {
+            detail::RelocateBytes(old_data_ + migrated_, count, data_ + migrated_);
+            migrated_ = last;
+        } else {
+            for (; migrated_ != last; ++migrated_) {
+                detail::UninitializedTransferN(old_data_ + migrated_, 1, data_ + migrated_);
+                std::destroy_at(old_data_ + migrated_);
+            }
+        }
+        if (!IsMigrating()) {
+            ReleaseOldData();
+        }
+    }
+
+    // Вне переноса все элементы лежат в data_, а old_size_ и migrated_ равны нулю
+    void ReleaseOldData() noexcept {
+        Memory empty(GetAllocator());
+        old_data_.Swap(empty);
+        old_size_ = migrated_ = 0;
+    }
+
+    void DestroyAll() noexcept {
+        std::destroy_n(data_.GetAddress(), migrated_);
+        std::destroy_n(old_data_ + migrated_, old_size_ - migrated_);
+        std::destroy_n(data_ + old_size_, size_ - old_size_);
+    }
+
+    Memory data_;
+    Memory old_data_;
+    size_t size_ = 0;
+    size_t old_size_ = 0;
+    size_t migrated_ = 0;
+    size_t step_ = kMinMigrationStep;
+};
@@ -0,0 +1,316 @@
+#pragma once
+#include "serialization.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+enum class MapMode {
+    // Файл открывается только для чтения, страницы разделяются со всеми процессами, отобразившими его
+    kReadOnly,
+    // Файл создаётся при отсутствии, изменения записываются в него
+    kReadWrite,
+};
+
+// Вектор тривиально копируемых элементов, хранящихся в отображённом в память файле (POSIX).
+// Файл имеет формат serialization.h: заголовок VectorFileHeader и элементы, поэтому открытие
+// файла не требует разбора данных, а файл, записанный Save, открывается как MappedVector.
+// Reserve увеличивает файл и заново отображает его, так что указатели на элементы,
+// как и у Vector, становятся недействительными при росте
+template <typename T, typename Growth = DoublingGrowth>
+class MappedVector {
+    static_assert(std::is_trivially_copyable_v<T>, "MappedVector requires trivially copyable T");
+    static_assert(alignof(T) <= kVectorDataOffset, "MappedVector does not support such alignment");
+
+    static constexpr size_t kDataOffset = kVectorDataOffset;
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    MappedVector() = default;
+
+    explicit MappedVector(const std::string& path, MapMode mode = MapMode::kReadWrite) {
+        Open(path, mode);
+    }
+
+    MappedVector(const MappedVector&) = delete;
+    MappedVector& operator=(const MappedVector&) = delete;
+
+    MappedVector(MappedVector&& other) noexcept
+        : fd_(std::exchange(other.fd_, -1))
+        , map_(std::exchange(other.map_, nullptr))
+        , map_bytes_(std::exchange(other.map_bytes_, 0))
+        , mode_(other.mode_) {
+    }
+
+    MappedVector& operator=(MappedVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Close();
+            fd_ = std::exchange(rhs.fd_, -1);
+            map_ = std::exchange(rhs.map_, nullptr);
+            map_bytes_ = std::exchange(rhs.map_bytes_, 0);
+            mode_ = rhs.mode_;
+        }
+        return *this;
+    }
+
+    ~MappedVector() {
+        Close();
+    }
+
+    // Открывает файл path и отображает его в память. В режиме kReadWrite отсутствующий
+    // файл создаётся пустым. Ошибки ввода-вывода сообщаются через std::system_error,
+    // файл чужого формата - через std::runtime_error
+    void Open(const std::string& path, MapMode mode = MapMode::kReadWrite) {
+        Close();
+        const bool writable = mode == MapMode::kReadWrite;
+        const int fd = ::open(path.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+        if (fd < 0) {
+            detail::ThrowSystemError("open " + path);
+        }
+        fd_ = fd;
+        mode_ = mode;
+        try {
+            struct stat st;
+            if (::fstat(fd_, &st) != 0) {
+                detail::ThrowSystemError("fstat " + path);
+            }
+            size_t file_bytes = static_cast<size_t>(st.st_size);
+            if (file_bytes == 0 && writable) {
+                file_bytes = kDataOffset;
+                Truncate(file_bytes);
+                Map(file_bytes);
+                *Head() = MakeVectorFileHeader<T>(0);
+            } else {
+                if (file_bytes < kDataOffset) {
+                    throw std::runtime_error(path + " is not a MappedVector file");
+                }
+                Map(file_bytes);
+                const VectorFileHeader& header = *Head();
+                if (!IsVectorFileHeaderOf<T>(header) || header.size > Capacity()) {
+                    throw std::runtime_error(path + " is not a MappedVector file of this element type");
+                }
+            }
+        } catch (...) {
+            Close();
+            throw;
+        }
+    }
+
+    bool IsOpen() const noexcept {
+        return map_ != nullptr;
+    }
+
+    bool IsWritable() const noexcept {
+        return IsOpen() && mode_ == MapMode::kReadWrite;
+    }
+
+    // Освобождает отображение и закрывает файл. Изменения остаются в файле
+    void Close() noexcept {
+        if (map_ != nullptr) {
+            ::munmap(map_, map_bytes_);
+            map_ = nullptr;
+            map_bytes_ = 0;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    // Дожидается записи изменённых страниц на диск
+    void Sync() {
+        assert(IsOpen());
+        if (::msync(map_, map_bytes_, MS_SYNC) != 0) {
+            detail::ThrowSystemError("msync");
+        }
+    }
+
+    // Начинает запись изменённых страниц на диск и не ждёт её окончания
+    void SyncAsync() {
+        assert(IsOpen());
+        if (::msync(map_, map_bytes_, MS_ASYNC) != 0) {
+            detail::ThrowSystemError("msync");
+        }
+    }
+
+    // Просит ядро заранее прочитать страницы элементов [first, first + count) в фоне, чтобы
+    // первое обращение к ним не ждало диска. Это только подсказка, ошибки игнорируются
+    void Prefetch(size_t first, size_t count) const noexcept {
+        assert(first + count <= Size());
+        const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        const size_t begin = (kDataOffset + first * sizeof(T)) / page * page;
+        const size_t end = kDataOffset + (first + count) * sizeof(T);
+        if (count != 0) {
+            ::madvise(static_cast<char*>(map_) + begin, end - begin, MADV_WILLNEED);
+        }
+    }
+
+    void Prefetch() const noexcept {
+        Prefetch(0, Size());
+    }
+
+    size_t Size() const noexcept {
+        // Файл может расти в другом процессе, поэтому размер ограничивается своим отображением
+        return IsOpen() ? std::min(static_cast<size_t>(Head()->size), Capacity()) : 0;
+    }
+
+    size_t Capacity() const noexcept {
+        return map_bytes_ > kDataOffset ? (map_bytes_ - kDataOffset) / sizeof(T) : 0;
+    }
+
+    T* Data() noexcept {
+        return IsOpen() ? reinterpret_cast<T*>(static_cast<unsigned char*>(map_) + kDataOffset) : nullptr;
+    }
+
+    const T* Data() const noexcept {
+        return const_cast<MappedVector&>(*this).Data();
+    }
+
+    iterator begin() noexcept {
+        return Data();
+    }
+    iterator end() noexcept {
+        return Data() + Size();
+    }
+    const_iterator begin() const noexcept {
+        return Data();
+    }
+    const_iterator end() const noexcept {
+        return Data() + Size();
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<MappedVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < Size());
+        return Data()[index];
+    }
+
+    // Увеличивает файл так, чтобы в нём поместились new_capacity элементов, и отображает его заново.
+    // Размер файла округляется до страницы, остаток страницы тоже становится вместимостью
+    void Reserve(size_t new_capacity) {
+        assert(IsWritable());
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+        const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        const size_t file_bytes = (kDataOffset + new_capacity * sizeof(T) + page - 1) / page * page;
+        Truncate(file_bytes);
+        Remap(file_bytes);
+    }
+
+    // Новые элементы заполняются нулями
+    void Resize(size_t new_size) {
+        assert(IsWritable());
+        const size_t size = Size();
+        if (new_size > size) {
+            Reserve(new_size);
+            std::memset(static_cast<void*>(Data() + size), 0, (new_size - size) * sizeof(T));
+        }
+        Head()->size = new_size;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        assert(IsWritable());
+        const size_t size = Size();
+        if (size == Capacity()) {
+            // Аргументы копируются до перевыделения: они могут ссылаться на элементы файла
+            T value(std::forward<Args>(args)...);
+            Reserve(Growth::NextCapacity(Capacity(), size + 1, sizeof(T)));
+            new (Data() + size) T(value);
+        } else {
+            new (Data() + size) T(std::forward<Args>(args)...);
+        }
+        Head()->size = size + 1;
+        return Data()[size];
+    }
+
+    void PopBack() noexcept {
+        assert(IsWritable());
+        if (Size() != 0) {
+            --Head()->size;
+        }
+    }
+
+    void Clear() noexcept {
+        assert(IsWritable());
+        Head()->size = 0;
+    }
+
+    // Уменьшает файл до размера вектора
+    void ShrinkToFit() {
+        assert(IsWritable());
+        const size_t file_bytes = kDataOffset + Size() * sizeof(T);
+        if (file_bytes < map_bytes_) {
+            Remap(file_bytes);
+            Truncate(file_bytes);
+        }
+    }
+
+private:
+    VectorFileHeader* Head() noexcept {
+        return static_cast<VectorFileHeader*>(map_);
+    }
+
+    const VectorFileHeader* Head() const noexcept {
+        return static_cast<const VectorFileHeader*>(map_);
+    }
+
+    int Protection() const noexcept {
+        return mode_ == MapMode::kReadWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+    }
+
+    void Truncate(size_t file_bytes) {
+        if (::ftruncate(fd_, static_cast<off_t>(file_bytes)) != 0) {
+            detail::ThrowSystemError("ftruncate");
+        }
+    }
+
+    void Map(size_t bytes) {
+        void* map = ::mmap(nullptr, bytes, Protection(), MAP_SHARED, fd_, 0);
+        if (map == MAP_FAILED) {
+            detail::ThrowSystemError("mmap");
+        }
+        map_ = map;
+        map_bytes_ = bytes;
+    }
+
+    // При неудаче прежнее отображение остаётся действительным
+    void Remap(size_t bytes) {
+#if defined(__linux__)
+        void* map = ::mremap(map_, map_bytes_, bytes, MREMAP_MAYMOVE);
+        if (map == MAP_FAILED) {
+            detail::ThrowSystemError("mremap");
+        }
+#else
+        void* map = ::mmap(nullptr, bytes, Protection(), MAP_SHARED, fd_, 0);
+        if (map == MAP_FAILED) {
+            detail::ThrowSystemError("mmap");
+        }
+        ::munmap(map_, map_bytes_);
+#endif
+        map_ = map;
+        map_bytes_ = bytes;
+    }
+
+    int fd_ = -1;
+    void* map_ = nullptr;
+    size_t map_bytes_ = 0;
+    MapMode mode_ = MapMode::kReadWrite;
+};
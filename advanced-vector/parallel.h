@@ -0,0 +1,40 @@
+#pragma once
+#include "vector.h"
+
+#include <thread>
+#include <vector>
+
+// Исполнитель массовых операций на std::thread: задача 0 выполняется в вызывающем потоке,
+// остальные - в отдельных потоках. Если поток создать не удалось, его задача выполняется
+// в вызывающем потоке. Потоки создаются на каждую операцию, поэтому исполнитель подходит
+// только для операций над большими объёмами памяти; пул потоков подключается через BulkExecutor
+inline void ThreadBulkExecutor(size_t count, BulkTask task, void* context) noexcept {
+    std::vector<std::thread> threads;
+    try {
+        threads.reserve(count - 1);
+    } catch (...) {
+    }
+    for (size_t i = 1; i < count; ++i) {
+        try {
+            threads.emplace_back(task, context, i);
+        } catch (...) {
+            task(context, i);
+        }
+    }
+    task(context, 0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+// Включает параллельное выполнение массовых операций Vector на threads потоках
+// для операций над threshold_bytes памяти и больше
+inline void EnableThreadParallelism(size_t threads = std::thread::hardware_concurrency(),
+                                    size_t threshold_bytes = BulkParallelism{}.threshold_bytes) noexcept {
+    SetBulkParallelism({&ThreadBulkExecutor, std::max<size_t>(threads, 1), threshold_bytes});
+}
+
+// Возвращает последовательное выполнение массовых операций
+inline void DisableParallelism() noexcept {
+    SetBulkParallelism({});
+}
@@ -0,0 +1,453 @@
+// Прогон микробенчмарков Vector со счётчиками процессора (perf_event_open, Linux) для поиска регрессий.
+// Для каждого замера в отчёт попадают такты, инструкции, промахи кэша и dTLB, страничные ошибки
+// и время в пересчёте на одну операцию, а также события политики CountingStats: выделения памяти,
+// перевыделения и перенесённые элементы. Рост с нуля сравнивается с ростом после Reserve,
+// разница показывает долю переноса элементов в новый буфер (SwapCopy).
+//
+// Сборка:    g++ -std=c++17 -O2 perf_harness.cpp -o perf_harness
+// Отчёт:     ./perf_harness --out=report.json
+// Сравнение: ./perf_harness --baseline=report.json --threshold=0.05
+// Параметры: --max-elements=N (1 G), --max-bytes=N (2 ГБ на буфер), --repetitions=N (5),
+//            --filter=подстрока имени. Код возврата 1, если найдена регрессия.
+// Счётчики, недоступные в системе (perf_event_paranoid, виртуальная машина), записываются как null
+// в JSON и как n/a в текстовом отчёте
+#include "vector.h"
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Тривиально копируемая запись на 16 байт
+struct Pod16 {
+    int64_t key;
+    int64_t value;
+};
+
+// Тип, перемещение которого может выбросить исключение: при росте он копируется
+struct ThrowingMove {
+    ThrowingMove() = default;
+    explicit ThrowingMove(std::string s)
+        : str(std::move(s)) {
+    }
+    ThrowingMove(const ThrowingMove&) = default;
+    ThrowingMove(ThrowingMove&& other) noexcept(false)
+        : str(std::move(other.str)) {
+    }
+    ThrowingMove& operator=(const ThrowingMove&) = default;
+    ThrowingMove& operator=(ThrowingMove&& other) noexcept(false) {
+        str = std::move(other.str);
+        return *this;
+    }
+
+    std::string str;
+};
+
+template <typename T>
+T MakeValue(size_t i) {
+    if constexpr (std::is_same_v<T, Pod16>) {
+        return {static_cast<int64_t>(i), static_cast<int64_t>(i)};
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        return std::string(1, static_cast<char>('a' + i % 26));
+    } else if constexpr (std::is_same_v<T, ThrowingMove>) {
+        return ThrowingMove(std::string(1, static_cast<char>('a' + i % 26)));
+    } else {
+        return static_cast<T>(i);
+    }
+}
+
+// Счётчики в порядке вывода
+enum Event {
+    kCycles,
+    kInstructions,
+    kCacheMisses,
+    kDtlbMisses,
+    kPageFaults,
+    kEventCount,
+};
+
+constexpr const char* kEventNames[kEventCount] = {"cycles", "instructions", "cache_misses", "dtlb_misses",
+                                                  "page_faults"};
+
+// Счётчики текущего потока в пользовательском режиме. Каждый открывается отдельно, поэтому
+// недоступный счётчик не мешает остальным; при мультиплексировании значения масштабируются
+class PerfCounters {
+public:
+    PerfCounters() {
+        Open(kCycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        Open(kInstructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        Open(kCacheMisses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        Open(kDtlbMisses, PERF_TYPE_HW_CACHE,
+             PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+        Open(kPageFaults, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters() {
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+    }
+
+    bool Has(Event event) const noexcept {
+        return fds_[event] >= 0;
+    }
+
+    void Start() noexcept {
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+    }
+
+    // Останавливает счётчики и записывает их значения в values
+    void Stop(double (&values)[kEventCount]) noexcept {
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+        for (int event = 0; event < kEventCount; ++event) {
+            uint64_t data[3] = {};  // значение, время включения, время работы
+            if (fds_[event] < 0 || ::read(fds_[event], data, sizeof(data)) != sizeof(data) || data[2] == 0) {
+                values[event] = 0;
+                continue;
+            }
+            values[event] = static_cast<double>(data[0]) * static_cast<double>(data[1]) / static_cast<double>(data[2]);
+        }
+    }
+
+private:
+    void Open(Event event, uint32_t type, uint64_t config) noexcept {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        fds_[event] = static_cast<int>(::syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    int fds_[kEventCount] = {-1, -1, -1, -1, -1};
+};
+
+// Результат одного замера в пересчёте на операцию
+struct Result {
+    std::string name;
+    size_t elements = 0;
+    double ns = 0;
+    double events[kEventCount] = {};
+    bool has_event[kEventCount] = {};
+    // События CountingStats на один прогон (один вектор от пустого до elements)
+    double allocations = 0;
+    double reallocations = 0;
+    double elements_moved = 0;
+    double elements_copied = 0;
+    double elements_relocated = 0;
+};
+
+struct Options {
+    std::string out;
+    std::string baseline;
+    std::string filter;
+    double threshold = 0.05;
+    size_t max_elements = size_t{1} << 30;
+    size_t max_bytes = size_t{2} << 30;
+    size_t repetitions = 5;
+};
+
+// Медиана измерений: отдельные выбросы из-за прерываний и миграции потока не влияют на отчёт
+double Median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+// Выполняет body(runs) repetitions раз, каждый раз со сброшенными счётчиками. runs подобрано так,
+// чтобы один замер обрабатывал не меньше 2^22 элементов
+template <typename Stats, typename Body>
+Result Measure(PerfCounters& counters, const Options& options, const std::string& name, size_t elements, Body body) {
+    constexpr size_t kMinElementsPerSample = size_t{1} << 22;
+    const size_t runs = std::max<size_t>(1, kMinElementsPerSample / elements);
+    const double ops = static_cast<double>(runs) * static_cast<double>(elements);
+
+    std::vector<double> ns;
+    std::vector<double> events[kEventCount];
+    VectorStats stats;
+    body(1);  // прогрев: страницы аллокатора и кэши инструкций
+    for (size_t rep = 0; rep < options.repetitions; ++rep) {
+        Stats::Reset();
+        double values[kEventCount];
+        const auto start = std::chrono::steady_clock::now();
+        counters.Start();
+        body(runs);
+        counters.Stop(values);
+        const auto stop = std::chrono::steady_clock::now();
+        stats = Stats::Snapshot();
+        ns.push_back(std::chrono::duration<double, std::nano>(stop - start).count() / ops);
+        for (int event = 0; event < kEventCount; ++event) {
+            events[event].push_back(values[event] / ops);
+        }
+    }
+
+    Result result;
+    result.name = name;
+    result.elements = elements;
+    result.ns = Median(ns);
+    for (int event = 0; event < kEventCount; ++event) {
+        result.has_event[event] = counters.Has(static_cast<Event>(event));
+        result.events[event] = Median(events[event]);
+    }
+    size_t reallocations = 0;
+    for (size_t count : stats.reallocations) {
+        reallocations += count;
+    }
+    const auto per_run = [runs](size_t count) {
+        return static_cast<double>(count) / static_cast<double>(runs);
+    };
+    result.allocations = per_run(stats.allocations);
+    result.reallocations = per_run(reallocations);
+    result.elements_moved = per_run(stats.elements_moved);
+    result.elements_copied = per_run(stats.elements_copied);
+    result.elements_relocated = per_run(stats.elements_relocated);
+    return result;
+}
+
+template <typename T>
+struct SweepTag {};
+
+// Рост вектора от 1 до max_elements элементов с шагом 4x: PushBack с нуля и после Reserve
+template <typename T>
+void Sweep(PerfCounters& counters, const Options& options, const std::string& type_name, std::vector<Result>& results) {
+    using Stats = CountingStats<SweepTag<T>>;
+    using Vec = Vector<T, std::allocator<T>, DoublingGrowth, NoShrink, Stats>;
+    for (size_t n = 1; n <= options.max_elements; n *= 4) {
+        // При росте старый и новый буферы существуют одновременно
+        if (n * sizeof(T) > options.max_bytes / 2) {
+            break;
+        }
+        const std::string growth_name = "PushBack/" + type_name + "/" + std::to_string(n);
+        if (growth_name.find(options.filter) != std::string::npos) {
+            results.push_back(Measure<Stats>(counters, options, growth_name, n, [n](size_t runs) {
+                for (size_t run = 0; run < runs; ++run) {
+                    Vec vec;
+                    for (size_t i = 0; i < n; ++i) {
+                        vec.PushBack(MakeValue<T>(i));
+                    }
+                    asm volatile("" : : "r"(vec.Data()) : "memory");
+                }
+            }));
+        }
+        const std::string reserved_name = "ReservedPushBack/" + type_name + "/" + std::to_string(n);
+        if (reserved_name.find(options.filter) != std::string::npos) {
+            results.push_back(Measure<Stats>(counters, options, reserved_name, n, [n](size_t runs) {
+                for (size_t run = 0; run < runs; ++run) {
+                    Vec vec;
+                    vec.Reserve(n);
+                    for (size_t i = 0; i < n; ++i) {
+                        vec.PushBack(MakeValue<T>(i));
+                    }
+                    asm volatile("" : : "r"(vec.Data()) : "memory");
+                }
+            }));
+        }
+        if (n > options.max_elements / 4) {
+            break;
+        }
+    }
+}
+
+void PrintNumber(std::ostream& out, bool has, double value) {
+    if (has) {
+        out << value;
+    } else {
+        out << "null";
+    }
+}
+
+// Значение счётчика для текстового отчёта; недоступный счётчик печатается как n/a, а не как ноль
+std::string FormatEvent(const Result& r, Event event) {
+    char buf[32];
+    if (r.has_event[event]) {
+        std::snprintf(buf, sizeof(buf), "%10.3f", r.events[event]);
+    } else {
+        std::snprintf(buf, sizeof(buf), "%10s", "n/a");
+    }
+    return buf;
+}
+
+// Отчёт - JSON с одним результатом на строке, чтобы его было легко читать и сравнивать построчно
+void WriteReport(std::ostream& out, const std::vector<Result>& results) {
+    out.precision(6);
+    out << "{\n  \"context\": {\"compiler\": \"" << __VERSION__ << "\", \"hardware_concurrency\": "
+        << std::thread::hardware_concurrency() << "},\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"elements\": " << r.elements << ", \"ns\": " << r.ns;
+        for (int event = 0; event < kEventCount; ++event) {
+            out << ", \"" << kEventNames[event] << "\": ";
+            PrintNumber(out, r.has_event[event], r.events[event]);
+        }
+        out << ", \"allocations\": " << r.allocations << ", \"reallocations\": " << r.reallocations
+            << ", \"elements_moved\": " << r.elements_moved << ", \"elements_copied\": " << r.elements_copied
+            << ", \"elements_relocated\": " << r.elements_relocated << "}" << (i + 1 < results.size() ? "," : "")
+            << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+// Читает числовое поле key из строки отчёта. null и отсутствующее поле - false
+bool ReadField(const std::string& line, const std::string& key, double& value) {
+    const size_t pos = line.find("\"" + key + "\": ");
+    if (pos == std::string::npos) {
+        return false;
+    }
+    const char* begin = line.c_str() + pos + key.size() + 4;
+    char* end = nullptr;
+    value = std::strtod(begin, &end);
+    return end != begin;
+}
+
+// Показатели, по которым ищутся регрессии. Время не сравнивается: на общей машине оно
+// слишком шумное, такты и инструкции его заменяют
+const std::vector<std::string>& ComparedMetrics() {
+    static const std::vector<std::string> metrics = {"cycles", "instructions", "cache_misses", "dtlb_misses",
+                                                     "page_faults", "allocations", "elements_moved",
+                                                     "elements_copied"};
+    return metrics;
+}
+
+// Сравнивает результаты с отчётом baseline и печатает показатели, выросшие больше чем на threshold.
+// Возвращает число регрессий
+size_t CompareWithBaseline(const std::vector<Result>& results, const Options& options) {
+    std::ifstream in(options.baseline);
+    if (!in) {
+        std::fprintf(stderr, "cannot open baseline %s\n", options.baseline.c_str());
+        return 1;
+    }
+    std::map<std::string, std::string> baseline;
+    for (std::string line; std::getline(in, line);) {
+        const size_t pos = line.find("\"name\": \"");
+        if (pos != std::string::npos) {
+            const size_t begin = pos + 9;
+            baseline[line.substr(begin, line.find('"', begin) - begin)] = line;
+        }
+    }
+    std::ostringstream current_report;
+    WriteReport(current_report, results);
+    std::istringstream current(current_report.str());
+
+    size_t regressions = 0;
+    for (std::string line; std::getline(current, line);) {
+        const size_t pos = line.find("\"name\": \"");
+        if (pos == std::string::npos) {
+            continue;
+        }
+        const size_t begin = pos + 9;
+        const std::string name = line.substr(begin, line.find('"', begin) - begin);
+        const auto it = baseline.find(name);
+        if (it == baseline.end()) {
+            continue;
+        }
+        for (const std::string& metric : ComparedMetrics()) {
+            double base = 0;
+            double value = 0;
+            if (!ReadField(it->second, metric, base) || !ReadField(line, metric, value)) {
+                continue;
+            }
+            // Доли события на операцию не сравниваются: они не отличимы от шума
+            constexpr double kNoise = 1e-3;
+            if (value > base * (1 + options.threshold) && value - base > kNoise) {
+                std::printf("REGRESSION %-40s %-14s %12.4f -> %12.4f (%+.1f%%)\n", name.c_str(), metric.c_str(), base,
+                            value, base > 0 ? (value / base - 1) * 100 : 100.0);
+                ++regressions;
+            }
+        }
+    }
+    return regressions;
+}
+
+bool ParseOption(const char* arg, const char* name, std::string& value) {
+    const size_t len = std::strlen(name);
+    if (std::strncmp(arg, name, len) == 0 && arg[len] == '=') {
+        value = arg + len + 1;
+        return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string value;
+        if (ParseOption(argv[i], "--out", options.out) || ParseOption(argv[i], "--baseline", options.baseline)
+            || ParseOption(argv[i], "--filter", options.filter)) {
+            continue;
+        }
+        if (ParseOption(argv[i], "--threshold", value)) {
+            options.threshold = std::stod(value);
+        } else if (ParseOption(argv[i], "--max-elements", value)) {
+            options.max_elements = std::stoull(value);
+        } else if (ParseOption(argv[i], "--max-bytes", value)) {
+            options.max_bytes = std::stoull(value);
+        } else if (ParseOption(argv[i], "--repetitions", value)) {
+            options.repetitions = std::max<size_t>(1, std::stoull(value));
+        } else {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    PerfCounters counters;
+    for (int event = 0; event < kEventCount; ++event) {
+        if (!counters.Has(static_cast<Event>(event))) {
+            std::fprintf(stderr, "counter %s is unavailable\n", kEventNames[event]);
+        }
+    }
+
+    std::vector<Result> results;
+    Sweep<int>(counters, options, "int", results);
+    Sweep<Pod16>(counters, options, "Pod16", results);
+    Sweep<std::string>(counters, options, "NothrowMovable", results);
+    Sweep<ThrowingMove>(counters, options, "ThrowingMove", results);
+
+    for (const Result& r : results) {
+        std::printf("%-40s %10.3f ns %s cycles %s instr %8.4f allocs/run\n", r.name.c_str(), r.ns,
+                    FormatEvent(r, kCycles).c_str(), FormatEvent(r, kInstructions).c_str(), r.allocations);
+    }
+    if (!options.out.empty()) {
+        std::ofstream out(options.out);
+        WriteReport(out, results);
+    }
+    if (!options.baseline.empty()) {
+        const size_t regressions = CompareWithBaseline(results, options);
+        std::printf("%zu regressions against %s\n", regressions, options.baseline.c_str());
+        return regressions == 0 ? 0 : 1;
+    }
+    return 0;
+}
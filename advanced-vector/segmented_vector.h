@@ -0,0 +1,317 @@
+#pragma once
+#include "vector.h"
+
+namespace detail {
+
+inline size_t FloorLog2(size_t value) noexcept {
+    assert(value != 0);
+#if defined(__GNUC__) || defined(__clang__)
+    return std::numeric_limits<unsigned long long>::digits - 1 - __builtin_clzll(value);
+#else
+    size_t result = 0;
+    while (value >>= 1) {
+        ++result;
+    }
+    return result;
+#endif
+}
+
+constexpr size_t ConstexprLog2(size_t value) noexcept {
+    size_t result = 0;
+    while (value >>= 1) {
+        ++result;
+    }
+    return result;
+}
+
+// Геометрическая раскладка сегментов: сегмент k вмещает FirstSegment << k элементов,
+// поэтому номер сегмента и смещение в нём вычисляются за O(1)
+template <size_t FirstSegment>
+struct GeometricSegments {
+    static_assert(FirstSegment > 0 && (FirstSegment & (FirstSegment - 1)) == 0,
+                  "first segment size must be a power of two");
+
+    static constexpr size_t kFirstSegmentLog2 = ConstexprLog2(FirstSegment);
+
+    static size_t SegmentOf(size_t index) noexcept {
+        return FloorLog2(index + FirstSegment) - kFirstSegmentLog2;
+    }
+
+    static size_t OffsetIn(size_t index, size_t segment) noexcept {
+        return index + FirstSegment - (FirstSegment << segment);
+    }
+
+    static size_t SegmentCapacity(size_t segment) noexcept {
+        return FirstSegment << segment;
+    }
+
+    // Суммарная вместимость сегментов [0, count)
+    static size_t TotalCapacity(size_t count) noexcept {
+        return (FirstSegment << count) - FirstSegment;
+    }
+};
+
+}  // namespace detail
+
+// Вектор из цепочки сегментов RawMemory геометрически растущего размера. При росте
+// добавляется новый сегмент, а существующие элементы не перемещаются, поэтому указатели
+// и ссылки на них остаются действительными до удаления самих элементов
+template <typename T, typename Alloc = std::allocator<T>, size_t FirstSegment = 64>
+class SegmentedVector {
+    using Layout = detail::GeometricSegments<FirstSegment>;
+
+public:
+    template <bool IsConst>
+    class BasicIterator {
+        using Owner = std::conditional_t<IsConst, const SegmentedVector, SegmentedVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+
+        BasicIterator() = default;
+        BasicIterator(Owner* owner, size_t index) noexcept
+            : owner_(owner)
+            , index_(index) {
+        }
+
+        template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+        BasicIterator(const BasicIterator<OtherConst>& other) noexcept
+            : owner_(other.owner_)
+            , index_(other.index_) {
+        }
+
+        reference operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+        pointer operator->() const noexcept {
+            return &**this;
+        }
+        reference operator[](difference_type n) const noexcept {
+            return (*owner_)[index_ + n];
+        }
+
+        BasicIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+        BasicIterator operator++(int) noexcept {
+            BasicIterator copy = *this;
+            ++index_;
+            return copy;
+        }
+        BasicIterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+        BasicIterator operator--(int) noexcept {
+            BasicIterator copy = *this;
+            --index_;
+            return copy;
+        }
+        BasicIterator& operator+=(difference_type n) noexcept {
+            index_ += n;
+            return *this;
+        }
+        BasicIterator& operator-=(difference_type n) noexcept {
+            index_ -= n;
+            return *this;
+        }
+        friend BasicIterator operator+(BasicIterator it, difference_type n) noexcept {
+            return it += n;
+        }
+        friend BasicIterator operator+(difference_type n, BasicIterator it) noexcept {
+            return it += n;
+        }
+        friend BasicIterator operator-(BasicIterator it, difference_type n) noexcept {
+            return it -= n;
+        }
+        friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+        friend bool operator!=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ != rhs.index_;
+        }
+        friend bool operator<(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ < rhs.index_;
+        }
+        friend bool operator>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ > rhs.index_;
+        }
+        friend bool operator<=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ <= rhs.index_;
+        }
+        friend bool operator>=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ >= rhs.index_;
+        }
+
+    private:
+        friend class BasicIterator<!IsConst>;
+
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    using value_type = T;
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+    iterator end() noexcept {
+        return {this, size_};
+    }
+    const_iterator begin() const noexcept {
+        return {this, 0};
+    }
+    const_iterator end() const noexcept {
+        return {this, size_};
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    SegmentedVector() = default;
+
+    explicit SegmentedVector(const Alloc& alloc)
+        : alloc_(alloc) {
+    }
+
+    SegmentedVector(const SegmentedVector& other)
+        : alloc_(std::allocator_traits<Alloc>::select_on_container_copy_construction(other.alloc_)) {
+        Reserve(other.size_);
+        try {
+            for (const T& value : other) {
+                EmplaceBack(value);
+            }
+        } catch (...) {
+            Clear();
+            throw;
+        }
+    }
+
+    SegmentedVector(SegmentedVector&& other) noexcept
+        : alloc_(other.alloc_)
+        , segments_(std::move(other.segments_))
+        , size_(std::exchange(other.size_, 0)) {
+    }
+
+    ~SegmentedVector() {
+        Clear();
+    }
+
+    SegmentedVector& operator=(const SegmentedVector& rhs) {
+        if (this != &rhs) {
+            SegmentedVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    SegmentedVector& operator=(SegmentedVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Swap(rhs);
+        }
+        return *this;
+    }
+
+    void Swap(SegmentedVector& other) noexcept {
+        using std::swap;
+        swap(alloc_, other.alloc_);
+        segments_.Swap(other.segments_);
+        std::swap(size_, other.size_);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return Layout::TotalCapacity(segments_.Size());
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SegmentedVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        const size_t segment = Layout::SegmentOf(index);
+        return segments_[segment][Layout::OffsetIn(index, segment)];
+    }
+
+    // Выделяет сегменты, пока вместимость меньше new_capacity. Элементы не перемещаются
+    void Reserve(size_t new_capacity) {
+        while (Capacity() < new_capacity) {
+            segments_.EmplaceBack(Layout::SegmentCapacity(segments_.Size()), alloc_);
+        }
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        Reserve(size_ + 1);
+        const size_t segment = Layout::SegmentOf(size_);
+        T* slot = segments_[segment] + Layout::OffsetIn(size_, segment);
+        new (slot) T(std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    void PopBack() {
+        if (size_ == 0) {
+            return;
+        }
+        std::destroy_at(&(*this)[size_ - 1]);
+        --size_;
+    }
+
+    // Разрушает элементы, сохраняя выделенные сегменты
+    void Clear() noexcept {
+        ForEachSegment([](T* data, size_t count) {
+            std::destroy_n(data, count);
+        });
+        size_ = 0;
+    }
+
+    // Вызывает f(data, count) для каждого непрерывного участка элементов по порядку
+    template <typename F>
+    void ForEachSegment(F f) {
+        size_t left = size_;
+        for (size_t segment = 0; left != 0; ++segment) {
+            const size_t count = std::min(left, Layout::SegmentCapacity(segment));
+            f(segments_[segment].GetAddress(), count);
+            left -= count;
+        }
+    }
+
+    template <typename F>
+    void ForEachSegment(F f) const {
+        const_cast<SegmentedVector&>(*this).ForEachSegment([&f](const T* data, size_t count) {
+            f(data, count);
+        });
+    }
+
+private:
+    Alloc alloc_;
+    Vector<RawMemory<T, Alloc>> segments_;
+    size_t size_ = 0;
+};
@@ -0,0 +1,237 @@
+#pragma once
+#include "vector.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if __has_include(<span>)
+#include <span>
+#endif
+
+// Двоичный формат векторов тривиально копируемых элементов: заголовок, дополненный нулями
+// до kVectorDataOffset байт, и сразу за ним элементы в представлении памяти. Этот же формат
+// использует MappedVector, поэтому сохранённый вектор можно отобразить в память без разбора
+struct VectorFileHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t element_size;
+    uint32_t alignment;
+    uint32_t reserved;
+    uint64_t size;
+};
+
+inline constexpr uint64_t kVectorFileMagic = 0x524f544345564d41;  // "AMVECTOR"
+inline constexpr uint32_t kVectorFileVersion = 1;
+// Смещение элементов от начала файла. Выравнивание элементов не должно его превышать
+inline constexpr size_t kVectorDataOffset = 64;
+
+static_assert(sizeof(VectorFileHeader) <= kVectorDataOffset);
+
+template <typename T>
+VectorFileHeader MakeVectorFileHeader(size_t size) noexcept {
+    return {kVectorFileMagic, kVectorFileVersion, static_cast<uint32_t>(sizeof(T)),
+            static_cast<uint32_t>(alignof(T)), 0, size};
+}
+
+// Подходит ли заголовок для элементов типа T
+template <typename T>
+bool IsVectorFileHeaderOf(const VectorFileHeader& header) noexcept {
+    return header.magic == kVectorFileMagic && header.version == kVectorFileVersion
+           && header.element_size == sizeof(T) && header.alignment == alignof(T);
+}
+
+namespace detail {
+
+template <typename T>
+constexpr void CheckSerializable() noexcept {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable elements can be serialized");
+    static_assert(alignof(T) <= kVectorDataOffset, "element alignment exceeds the data offset");
+}
+
+[[noreturn]] inline void ThrowSystemError(const std::string& what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+// Записывает все буферы iov, повторяя writev после частичной записи
+inline void WriteAll(int fd, iovec* iov, int count) {
+    while (count > 0) {
+        const ssize_t written = ::writev(fd, iov, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowSystemError("writev");
+        }
+        size_t left = static_cast<size_t>(written);
+        while (count > 0 && left >= iov->iov_len) {
+            left -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + left;
+            iov->iov_len -= left;
+        }
+    }
+}
+
+// Читает ровно bytes байт. Конец файла раньше времени - ошибка формата
+inline void ReadAll(int fd, void* buf, size_t bytes) {
+    auto* dst = static_cast<char*>(buf);
+    while (bytes > 0) {
+        const ssize_t got = ::read(fd, dst, bytes);
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowSystemError("read");
+        }
+        if (got == 0) {
+            throw std::runtime_error("unexpected end of vector data");
+        }
+        dst += got;
+        bytes -= static_cast<size_t>(got);
+    }
+}
+
+// Проверяет заголовок и возвращает число элементов
+template <typename T>
+size_t CheckedVectorSize(const unsigned char (&block)[kVectorDataOffset]) {
+    VectorFileHeader header;
+    std::memcpy(&header, block, sizeof(header));
+    if (!IsVectorFileHeaderOf<T>(header)) {
+        throw std::runtime_error("vector data has a different format or element type");
+    }
+    if (header.size > std::numeric_limits<size_t>::max() / sizeof(T)) {
+        throw std::runtime_error("vector data is too large");
+    }
+    return static_cast<size_t>(header.size);
+}
+
+// Проверяет, что в обычном файле после позиции offset помещаются size элементов, чтобы
+// обрезанный или испорченный файл не приводил к выделению памяти по размеру из заголовка.
+// Возвращает false, если размер данных заранее неизвестен: канал, сокет
+template <typename T>
+bool CheckVectorFits(int fd, size_t size, off_t offset) {
+    struct stat st;
+    if (offset < 0 || ::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+    if (st.st_size < offset || static_cast<uint64_t>(st.st_size - offset) / sizeof(T) < size) {
+        throw std::runtime_error("unexpected end of vector data");
+    }
+    return true;
+}
+
+// Порция чтения, когда размер данных заранее неизвестен: память растёт вместе с прочитанными
+// данными, а не сразу по заголовку
+inline constexpr size_t kLoadChunkBytes = size_t{1} << 20;
+
+// Читает size элементов порциями, увеличивая вместимость геометрически
+template <typename T, typename... Params, typename ReadBytes>
+void ReadVectorChunked(Vector<T, Params...>& vec, size_t size, ReadBytes read_bytes) {
+    const size_t chunk = std::max<size_t>(kLoadChunkBytes / sizeof(T), 1);
+    while (vec.Size() < size) {
+        const size_t old_size = vec.Size();
+        const size_t count = std::min(chunk, size - old_size);
+        vec.Reserve(std::min(size, std::max(old_size + count, vec.Capacity() * 2)));
+        vec.ResizeDefaultInit(old_size + count);
+        read_bytes(reinterpret_cast<char*>(vec.Data() + old_size), count * sizeof(T));
+    }
+}
+
+}  // namespace detail
+
+// Буфер живых элементов вектора для writev/sendmsg без копирования
+template <typename T, typename... Params>
+iovec AsIovec(const Vector<T, Params...>& vec) noexcept {
+    return {const_cast<T*>(vec.Data()), vec.Size() * sizeof(T)};
+}
+
+#if defined(__cpp_lib_span)
+template <typename T, typename... Params>
+std::span<const std::byte> AsBytes(const Vector<T, Params...>& vec) noexcept {
+    return std::as_bytes(std::span<const T>(vec));
+}
+#endif
+
+// Записывает вектор в файловый дескриптор одним writev: заголовок и элементы
+template <typename T, typename... Params>
+void Save(int fd, const Vector<T, Params...>& vec) {
+    detail::CheckSerializable<T>();
+    unsigned char block[kVectorDataOffset] = {};
+    const VectorFileHeader header = MakeVectorFileHeader<T>(vec.Size());
+    std::memcpy(block, &header, sizeof(header));
+    iovec iov[2] = {{block, sizeof(block)}, AsIovec(vec)};
+    detail::WriteAll(fd, iov, vec.Size() != 0 ? 2 : 1);
+}
+
+// Читает вектор, записанный Save. Для обычного файла размер из заголовка сверяется с размером
+// файла, память выделяется один раз, элементы не инициализируются перед чтением. Из канала
+// или сокета элементы читаются порциями по kLoadChunkBytes. При ошибке вектор остаётся пустым
+template <typename T, typename... Params>
+void Load(int fd, Vector<T, Params...>& vec) {
+    detail::CheckSerializable<T>();
+    vec.Clear();
+    try {
+        unsigned char block[kVectorDataOffset];
+        detail::ReadAll(fd, block, sizeof(block));
+        const size_t size = detail::CheckedVectorSize<T>(block);
+        const auto read_bytes = [fd](char* dst, size_t bytes) {
+            detail::ReadAll(fd, dst, bytes);
+        };
+        if (detail::CheckVectorFits<T>(fd, size, ::lseek(fd, 0, SEEK_CUR))) {
+            vec.ResizeDefaultInit(size);
+            read_bytes(reinterpret_cast<char*>(vec.Data()), size * sizeof(T));
+        } else {
+            detail::ReadVectorChunked(vec, size, read_bytes);
+        }
+    } catch (...) {
+        vec.Clear();
+        throw;
+    }
+}
+
+// То же для потоков. Ошибки потока сообщаются через std::ios_base::failure
+template <typename T, typename... Params>
+void Save(std::ostream& out, const Vector<T, Params...>& vec) {
+    detail::CheckSerializable<T>();
+    unsigned char block[kVectorDataOffset] = {};
+    const VectorFileHeader header = MakeVectorFileHeader<T>(vec.Size());
+    std::memcpy(block, &header, sizeof(header));
+    out.write(reinterpret_cast<const char*>(block), sizeof(block));
+    out.write(reinterpret_cast<const char*>(vec.Data()), static_cast<std::streamsize>(vec.Size() * sizeof(T)));
+    if (!out) {
+        throw std::ios_base::failure("failed to write vector data");
+    }
+}
+
+// Размер потока заранее неизвестен, поэтому элементы читаются порциями, как из канала
+template <typename T, typename... Params>
+void Load(std::istream& in, Vector<T, Params...>& vec) {
+    detail::CheckSerializable<T>();
+    vec.Clear();
+    try {
+        unsigned char block[kVectorDataOffset];
+        if (!in.read(reinterpret_cast<char*>(block), sizeof(block))) {
+            throw std::ios_base::failure("failed to read vector header");
+        }
+        detail::ReadVectorChunked(vec, detail::CheckedVectorSize<T>(block), [&in](char* dst, size_t bytes) {
+            if (!in.read(dst, static_cast<std::streamsize>(bytes))) {
+                throw std::ios_base::failure("failed to read vector data");
+            }
+        });
+    } catch (...) {
+        vec.Clear();
+        throw;
+    }
+}
@@ -0,0 +1,158 @@
+#pragma once
+#include "vector.h"
+
+// Вектор с копированием при записи. Копии и снимки (Snapshot) разделяют один Vector
+// со счётчиком ссылок и создаются за O(1). Первая модификация разделяемого вектора
+// копирует его элементы, после чего объект владеет своей копией единолично.
+// Ссылки и итераторы, полученные через неконстантный доступ, становятся недействительными
+// после следующей копии или снимка, как у Vector после перевыделения памяти
+template <typename T, typename... Params>
+class SharedVector {
+public:
+    using VectorType = Vector<T, Params...>;
+    using value_type = T;
+    using iterator = typename VectorType::iterator;
+    using const_iterator = typename VectorType::const_iterator;
+
+    SharedVector() = default;
+
+    explicit SharedVector(VectorType vec)
+        : data_(std::make_shared<VectorType>(std::move(vec))) {
+    }
+
+    // Неизменяемый снимок текущего содержимого за O(1)
+    SharedVector Snapshot() const noexcept {
+        return *this;
+    }
+
+    // Разделяет ли объект элементы с другими копиями
+    bool IsShared() const noexcept {
+        return data_ != nullptr && data_.use_count() > 1;
+    }
+
+    const VectorType& Get() const noexcept {
+        return data_ != nullptr ? *data_ : EmptyVector();
+    }
+
+    // Вектор во владении объекта. Если элементы разделяются, сначала создаётся их копия
+    VectorType& Mutable() {
+        if (data_ == nullptr) {
+            data_ = std::make_shared<VectorType>();
+        } else if (data_.use_count() != 1) {
+            data_ = std::make_shared<VectorType>(*data_);
+        } else {
+            // Согласуется с release-уменьшением счётчика в потоке, отпустившем последнюю копию:
+            // его чтения элементов завершены до наших записей
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *data_;
+    }
+
+    const_iterator begin() const noexcept {
+        return Get().begin();
+    }
+    const_iterator end() const noexcept {
+        return Get().end();
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    size_t Size() const noexcept {
+        return Get().Size();
+    }
+
+    size_t Capacity() const noexcept {
+        return Get().Capacity();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return Get()[index];
+    }
+
+    T& operator[](size_t index) {
+        return Mutable()[index];
+    }
+
+    void Reserve(size_t new_capacity) {
+        Mutable().Reserve(new_capacity);
+    }
+
+    void Resize(size_t new_size) {
+        Mutable().Resize(new_size);
+    }
+
+    void PushBack(const T& value) {
+        Mutable().PushBack(value);
+    }
+
+    void PushBack(T&& value) {
+        Mutable().PushBack(std::move(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        return Mutable().EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    void PopBack() {
+        Mutable().PopBack();
+    }
+
+    // Позиции задаются итераторами разделяемого буфера, поэтому переводятся в индексы до копирования.
+    // Возвращаемый итератор указывает в собственный буфер объекта
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args) {
+        const size_t idx = pos - begin();
+        VectorType& vec = Mutable();
+        vec.Emplace(vec.begin() + idx, std::forward<Args>(args)...);
+        return vec.begin() + idx;
+    }
+
+    iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    iterator Erase(const_iterator pos) {
+        const size_t idx = pos - begin();
+        VectorType& vec = Mutable();
+        vec.Erase(vec.begin() + idx);
+        return vec.begin() + idx;
+    }
+
+    iterator Erase(const_iterator first, const_iterator last) {
+        const size_t idx = first - begin();
+        const size_t count = last - first;
+        VectorType& vec = Mutable();
+        vec.Erase(vec.begin() + idx, vec.begin() + idx + count);
+        return vec.begin() + idx;
+    }
+
+    // Разделяемые элементы не копируются: объект просто отпускает свою ссылку на них
+    void Clear() noexcept {
+        if (IsShared()) {
+            data_.reset();
+        } else if (data_ != nullptr) {
+            data_->Clear();
+        }
+    }
+
+    void Swap(SharedVector& other) noexcept {
+        data_.swap(other.data_);
+    }
+
+private:
+    static const VectorType& EmptyVector() noexcept {
+        static const VectorType empty;
+        return empty;
+    }
+
+    std::shared_ptr<VectorType> data_;
+};
@@ -0,0 +1,566 @@
+#pragma once
+#include "views.h"
+
+#include <atomic>
+#include <cstdint>
+
+// Векторизованные алгоритмы над непрерывными последовательностями арифметических элементов
+// (Vector, VectorView, столбцы SoAVector). Ядра написаны на векторных расширениях GCC/Clang
+// и компилируются для каждого набора инструкций отдельно; нужный вариант выбирается при первом
+// вызове по возможностям процессора: AVX-512, AVX2 и SSE4.2 на x86, NEON на AArch64.
+// Хвост, не кратный ширине регистра, обрабатывается скалярно. Загрузки невыровненные:
+// на буфере из AlignedAllocator они выполняются так же быстро, как выровненные.
+// Sum и Dot для чисел с плавающей точкой суммируют в другом порядке, чем скалярный цикл,
+// поэтому результат может отличаться в последних разрядах. Min и Max при NaN не определены
+namespace simd {
+
+enum class Level {
+    kScalar,
+    kSse42,
+    kAvx2,
+    kAvx512,
+    kNeon,
+};
+
+namespace detail {
+
+#if defined(__GNUC__)
+#define ADVANCED_VECTOR_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define ADVANCED_VECTOR_ALWAYS_INLINE inline
+#endif
+
+template <typename T>
+inline constexpr bool kIsSimdElement = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+// Целые суммируются по модулю 2^N в беззнаковом типе: переполнение не является неопределённым
+// поведением, а результат не зависит от порядка сложения. В скалярном коде узкие типы расширяются
+// до unsigned, чтобы произведение не переполняло int
+template <typename T, bool = std::is_integral_v<T>>
+struct Accumulator {
+    using Scalar = T;
+    using Lane = T;
+};
+
+template <typename T>
+struct Accumulator<T, true> {
+    using Lane = std::make_unsigned_t<T>;
+    using Scalar = std::conditional_t<(sizeof(T) < sizeof(unsigned)), unsigned, Lane>;
+};
+
+// Скалярные версии алгоритмов. Они же обрабатывают хвосты в векторных ядрах
+struct ScalarKernels {
+    template <typename T>
+    static ADVANCED_VECTOR_ALWAYS_INLINE void Fill(T* dst, size_t n, T value) noexcept {
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = value;
+        }
+    }
+
+    template <typename T>
+    static ADVANCED_VECTOR_ALWAYS_INLINE T Sum(const T* src, size_t n) noexcept {
+        using Acc = typename Accumulator<T>::Scalar;
+        Acc sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += static_cast<Acc>(src[i]);
+        }
+        return static_cast<T>(sum);
+    }
+
+    template <typename T>
+    static ADVANCED_VECTOR_ALWAYS_INLINE T Dot(const T* a, const T* b, size_t n) noexcept {
+        using Acc = typename Accumulator<T>::Scalar;
+        Acc sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += static_cast<Acc>(a[i]) * static_cast<Acc>(b[i]);
+        }
+        return static_cast<T>(sum);
+    }
+
+    template <typename T>
+    static ADVANCED_VECTOR_ALWAYS_INLINE T Min(const T* src, size_t n) noexcept {
+        T result = src[0];
+        for (size_t i = 1; i < n; ++i) {
+            result = src[i] < result ? src[i] : result;
+        }
+        return result;
+    }
+
+    template <typename T>
+    static ADVANCED_VECTOR_ALWAYS_INLINE T Max(const T* src, size_t n) noexcept {
+        T result = src[0];
+        for (size_t i = 1; i < n; ++i) {
+            result = src[i] > result ? src[i] : result;
+        }
+        return result;
+    }
+
+    template <typename T>
+    static ADVANCED_VECTOR_ALWAYS_INLINE size_t Find(const T* src, size_t n, T value) noexcept {
+        for (size_t i = 0; i < n; ++i) {
+            if (src[i] == value) {
+                return i;
+            }
+        }
+        return n;
+    }
+
+    template <typename T>
+    static ADVANCED_VECTOR_ALWAYS_INLINE size_t Count(const T* src, size_t n, T value) noexcept {
+        size_t count = 0;
+        for (size_t i = 0; i < n; ++i) {
+            count += src[i] == value ? 1 : 0;
+        }
+        return count;
+    }
+
+    template <typename T, typename Operation>
+    static ADVANCED_VECTOR_ALWAYS_INLINE void Transform(const T* src, size_t n, T* dst, Operation& op) {
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = op(src[i]);
+        }
+    }
+
+    template <typename T>
+    static ADVANCED_VECTOR_ALWAYS_INLINE bool Equal(const T* a, const T* b, size_t n) noexcept {
+        for (size_t i = 0; i < n; ++i) {
+            if (!(a[i] == b[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+#if defined(__GNUC__)
+
+// Ядра на регистрах ширины Bytes. Компилируются в инструкции той функции, в которую встроены.
+// Векторы передаются между функциями только по ссылке: передача по значению зависит от набора
+// инструкций вызывающей функции
+template <size_t Bytes>
+struct VectorKernels {
+    template <typename T>
+    struct Types {
+        typedef T Vec __attribute__((vector_size(Bytes)));
+        // Вектор по адресу, выровненному лишь как T
+        typedef T Unaligned __attribute__((vector_size(Bytes), aligned(alignof(T)), may_alias));
+        static constexpr size_t kLanes = Bytes / sizeof(T);
+    };
+
+    template <typename T>
+    using Vec = typename Types<T>::Vec;
+
+    template <typename T>
+    static ADVANCED_VECTOR_ALWAYS_INLINE const typename Types<T>::Unaligned& Load(const T* src) noexcept {
+        return *reinterpret_cast<const typename Types<T>::Unaligned*>(src);
+    }
+
+    template <typename T>
+    static ADVANCED_VECTOR_ALWAYS_INLINE void Store(T* dst, const Vec<T>& v) noexcept {
+        *reinterpret_cast<typename Types<T>::Unaligned*>(dst) = v;
+    }
+
+    // Есть ли в маске сравнения хотя бы один истинный элемент
+    template <typename Mask>
+    static ADVANCED_VECTOR_ALWAYS_INLINE bool Any(const Mask& mask) noexcept {
+        const auto words = reinterpret_cast<Vec<uint64_t>>(mask);
+        uint64_t any = 0;
+        for (size_t i = 0; i < Types<uint64_t>::kLanes; ++i) {
+            any |= words[i];
+        }
+        return any != 0;
+    }
+
+    template <typename T>
+    static ADVANCED_VECTOR_ALWAYS_INLINE T HorizontalSum(const Vec<typename Accumulator<T>::Lane>& v) noexcept {
+        using Acc = typename Accumulator<T>::Scalar;
+        Acc sum = 0;
+        for (size_t i = 0; i < Types<T>::kLanes; ++i) {
+            sum += static_cast<Acc>(v[i]);
+        }
+        return static_cast<T>(sum);
+    }
+
+    template <typename T>
+    static ADVANCED_VECTOR_ALWAYS_INLINE void Fill(T* dst, size_t n, T value) noexcept {
+        constexpr size_t kLanes = Types<T>::kLanes;
+        const Vec<T> v = Vec<T>{} + value;
+        size_t i = 0;
+        for (; i + kLanes <= n; i += kLanes) {
+            Store(dst + i, v);
+        }
+        ScalarKernels::Fill(dst + i, n - i, value);
+    }
+
+    template <typename T>
+    static ADVANCED_VECTOR_ALWAYS_INLINE T Sum(const T* src, size_t n) noexcept {
+        constexpr size_t kLanes = Types<T>::kLanes;
+        using Acc = Vec<typename Accumulator<T>::Lane>;
+        // Два независимых аккумулятора скрывают задержку сложения
+        Acc acc0 = {};
+        Acc acc1 = {};
+        size_t i = 0;
+        for (; i + 2 * kLanes <= n; i += 2 * kLanes) {
+            acc0 += reinterpret_cast<Acc>(Load(src + i));
+            acc1 += reinterpret_cast<Acc>(Load(src + i + kLanes));
+        }
+        if (i + kLanes <= n) {
+            acc0 += reinterpret_cast<Acc>(Load(src + i));
+            i += kLanes;
+        }
+        return HorizontalSum<T>(acc0 + acc1) + ScalarKernels::Sum(src + i, n - i);
+    }
+
+    template <typename T>
+    static ADVANCED_VECTOR_ALWAYS_INLINE T Dot(const T* a, const T* b, size_t n) noexcept {
+        constexpr size_t kLanes = Types<T>::kLanes;
+        using Acc = Vec<typename Accumulator<T>::Lane>;
+        Acc acc0 = {};
+        Acc acc1 = {};
+        size_t i = 0;
+        for (; i + 2 * kLanes <= n; i += 2 * kLanes) {
+            acc0 += reinterpret_cast<Acc>(Load(a + i)) * reinterpret_cast<Acc>(Load(b + i));
+            acc1 += reinterpret_cast<Acc>(Load(a + i + kLanes)) * reinterpret_cast<Acc>(Load(b + i + kLanes));
+        }
+        if (i + kLanes <= n) {
+            acc0 += reinterpret_cast<Acc>(Load(a + i)) * reinterpret_cast<Acc>(Load(b + i));
+            i += kLanes;
+        }
+        return HorizontalSum<T>(acc0 + acc1) + ScalarKernels::Dot(a + i, b + i, n - i);
+    }
+
+    template <typename T>
+    static ADVANCED_VECTOR_ALWAYS_INLINE T Min(const T* src, size_t n) noexcept {
+        constexpr size_t kLanes = Types<T>::kLanes;
+        if (n < kLanes) {
+            return ScalarKernels::Min(src, n);
+        }
+        Vec<T> acc = Load(src);
+        size_t i = kLanes;
+        for (; i + kLanes <= n; i += kLanes) {
+            const Vec<T> v = Load(src + i);
+            acc = v < acc ? v : acc;
+        }
+        T result = ScalarKernels::Min(reinterpret_cast<const T*>(&acc), kLanes);
+        return i == n ? result : std::min(result, ScalarKernels::Min(src + i, n - i));
+    }
+
+    template <typename T>
+    static ADVANCED_VECTOR_ALWAYS_INLINE T Max(const T* src, size_t n) noexcept {
+        constexpr size_t kLanes = Types<T>::kLanes;
+        if (n < kLanes) {
+            return ScalarKernels::Max(src, n);
+        }
+        Vec<T> acc = Load(src);
+        size_t i = kLanes;
+        for (; i + kLanes <= n; i += kLanes) {
+            const Vec<T> v = Load(src + i);
+            acc = v > acc ? v : acc;
+        }
+        T result = ScalarKernels::Max(reinterpret_cast<const T*>(&acc), kLanes);
+        return i == n ? result : std::max(result, ScalarKernels::Max(src + i, n - i));
+    }
+
+    template <typename T>
+    static ADVANCED_VECTOR_ALWAYS_INLINE size_t Find(const T* src, size_t n, T value) noexcept {
+        constexpr size_t kLanes = Types<T>::kLanes;
+        const Vec<T> needle = Vec<T>{} + value;
+        size_t i = 0;
+        for (; i + kLanes <= n; i += kLanes) {
+            if (Any(Load(src + i) == needle)) {
+                return i + ScalarKernels::Find(src + i, kLanes, value);
+            }
+        }
+        return i + ScalarKernels::Find(src + i, n - i, value);
+    }
+
+    template <typename T>
+    static ADVANCED_VECTOR_ALWAYS_INLINE size_t Count(const T* src, size_t n, T value) noexcept {
+        constexpr size_t kLanes = Types<T>::kLanes;
+        // Истинный элемент маски равен -1. Счётчики сбрасываются, пока узкие целые не переполнились
+        constexpr size_t kFlushEvery = 64;
+        using Mask = decltype(Vec<T>{} == Vec<T>{});
+        const Vec<T> needle = Vec<T>{} + value;
+        size_t count = 0;
+        size_t i = 0;
+        while (i + kLanes <= n) {
+            Mask acc = {};
+            for (size_t block = 0; block < kFlushEvery && i + kLanes <= n; ++block, i += kLanes) {
+                acc -= Load(src + i) == needle;
+            }
+            for (size_t lane = 0; lane < kLanes; ++lane) {
+                count += static_cast<size_t>(acc[lane]);
+            }
+        }
+        return count + ScalarKernels::Count(src + i, n - i, value);
+    }
+
+    template <typename T, typename Operation>
+    static ADVANCED_VECTOR_ALWAYS_INLINE void Transform(const T* src, size_t n, T* dst, Operation& op) {
+        // op вызывается для элементов блока шириной в регистр. Блок читается целиком до записи,
+        // поэтому dst может совпадать с src, а встроенный op компилятор векторизует
+        constexpr size_t kLanes = Types<T>::kLanes;
+        size_t i = 0;
+        for (; i + kLanes <= n; i += kLanes) {
+            Vec<T> block = Load(src + i);
+            for (size_t lane = 0; lane < kLanes; ++lane) {
+                block[lane] = op(block[lane]);
+            }
+            Store(dst + i, block);
+        }
+        ScalarKernels::Transform(src + i, n - i, dst + i, op);
+    }
+
+    template <typename T>
+    static ADVANCED_VECTOR_ALWAYS_INLINE bool Equal(const T* a, const T* b, size_t n) noexcept {
+        constexpr size_t kLanes = Types<T>::kLanes;
+        size_t i = 0;
+        for (; i + kLanes <= n; i += kLanes) {
+            if (Any(Load(a + i) != Load(b + i))) {
+                return false;
+            }
+        }
+        return ScalarKernels::Equal(a + i, b + i, n - i);
+    }
+};
+
+// Обёртки, компилирующие ядра для конкретного набора инструкций
+#define ADVANCED_VECTOR_SIMD_ISA(Name, Target, Bytes)                                                     \
+    struct Name {                                                                                        \
+        using Kernels = VectorKernels<Bytes>;                                                            \
+        template <typename T>                                                                            \
+        Target static void Fill(T* dst, size_t n, T value) noexcept {                                    \
+            Kernels::Fill(dst, n, value);                                                                \
+        }                                                                                                \
+        template <typename T>                                                                            \
+        Target static T Sum(const T* src, size_t n) noexcept {                                           \
+            return Kernels::Sum(src, n);                                                                 \
+        }                                                                                                \
+        template <typename T>                                                                            \
+        Target static T Dot(const T* a, const T* b, size_t n) noexcept {                                 \
+            return Kernels::Dot(a, b, n);                                                                \
+        }                                                                                                \
+        template <typename T>                                                                            \
+        Target static T Min(const T* src, size_t n) noexcept {                                           \
+            return Kernels::Min(src, n);                                                                 \
+        }                                                                                                \
+        template <typename T>                                                                            \
+        Target static T Max(const T* src, size_t n) noexcept {                                           \
+            return Kernels::Max(src, n);                                                                 \
+        }                                                                                                \
+        template <typename T>                                                                            \
+        Target static size_t Find(const T* src, size_t n, T value) noexcept {                            \
+            return Kernels::Find(src, n, value);                                                         \
+        }                                                                                                \
+        template <typename T>                                                                            \
+        Target static size_t Count(const T* src, size_t n, T value) noexcept {                           \
+            return Kernels::Count(src, n, value);                                                        \
+        }                                                                                                \
+        template <typename T, typename Operation>                                                        \
+        Target static void Transform(const T* src, size_t n, T* dst, Operation& op) {                    \
+            Kernels::Transform(src, n, dst, op);                                                         \
+        }                                                                                                \
+        template <typename T>                                                                            \
+        Target static bool Equal(const T* a, const T* b, size_t n) noexcept {                            \
+            return Kernels::Equal(a, b, n);                                                              \
+        }                                                                                                \
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+ADVANCED_VECTOR_SIMD_ISA(Sse42Kernels, __attribute__((target("sse4.2"))), 16);
+ADVANCED_VECTOR_SIMD_ISA(Avx2Kernels, __attribute__((target("avx2"))), 32);
+ADVANCED_VECTOR_SIMD_ISA(Avx512Kernels, __attribute__((target("avx512f,avx512bw"))), 64);
+#elif defined(__aarch64__)
+// NEON входит в базовый набор AArch64, отдельный target не нужен
+ADVANCED_VECTOR_SIMD_ISA(NeonKernels, , 16);
+#endif
+
+#undef ADVANCED_VECTOR_SIMD_ISA
+
+
+#endif  // defined(__GNUC__)
+
+inline Level DetectLevel() noexcept {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return Level::kAvx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return Level::kAvx2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return Level::kSse42;
+    }
+#elif defined(__GNUC__) && defined(__aarch64__)
+    return Level::kNeon;
+#endif
+    return Level::kScalar;
+}
+
+inline std::atomic<Level>& ActiveLevelStorage() noexcept {
+    static std::atomic<Level> level{DetectLevel()};
+    return level;
+}
+
+// Вызывает f(kernels) с ядрами выбранного набора инструкций
+template <typename F>
+decltype(auto) Dispatch(F&& f) {
+    switch (ActiveLevelStorage().load(std::memory_order_relaxed)) {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        case Level::kAvx512:
+            return f(Avx512Kernels{});
+        case Level::kAvx2:
+            return f(Avx2Kernels{});
+        case Level::kSse42:
+            return f(Sse42Kernels{});
+#elif defined(__GNUC__) && defined(__aarch64__)
+        case Level::kNeon:
+            return f(NeonKernels{});
+#endif
+        default:
+            return f(ScalarKernels{});
+    }
+}
+
+template <typename T>
+constexpr void CheckSimdElement() noexcept {
+    static_assert(kIsSimdElement<T>, "SIMD algorithms support arithmetic element types only");
+}
+
+}  // namespace detail
+
+// Лучший набор инструкций, поддерживаемый процессором
+inline Level DetectedLevel() noexcept {
+    static const Level level = detail::DetectLevel();
+    return level;
+}
+
+inline Level ActiveLevel() noexcept {
+    return detail::ActiveLevelStorage().load(std::memory_order_relaxed);
+}
+
+// Ограничивает используемый набор инструкций, например kScalar для сравнения с эталоном.
+// Уровни выше поддерживаемых процессором заменяются на DetectedLevel()
+inline void SetLevel(Level level) noexcept {
+    const Level detected = DetectedLevel();
+    if (level != Level::kScalar && static_cast<int>(level) > static_cast<int>(detected)) {
+        level = detected;
+    }
+#if defined(__aarch64__)
+    if (level != Level::kScalar) {
+        level = detected;
+    }
+#endif
+    detail::ActiveLevelStorage().store(level, std::memory_order_relaxed);
+}
+
+// Алгоритмы принимают Vector, VectorView, MappedVector и другие контейнеры с Data() и Size()
+
+template <typename Range, typename T>
+void Fill(Range&& range, T value) noexcept {
+    const auto view = VectorView(range);
+    using Element = typename decltype(view)::value_type;
+    detail::CheckSimdElement<Element>();
+    detail::Dispatch([&](auto kernels) {
+        kernels.Fill(view.Data(), view.Size(), static_cast<Element>(value));
+    });
+}
+
+template <typename Range>
+auto Sum(const Range& range) noexcept {
+    const VectorView view(range);
+    using Element = typename decltype(view)::value_type;
+    detail::CheckSimdElement<Element>();
+    return detail::Dispatch([&](auto kernels) {
+        return kernels.Sum(view.Data(), view.Size());
+    });
+}
+
+// Скалярное произведение. Размеры a и b должны совпадать
+template <typename RangeA, typename RangeB>
+auto Dot(const RangeA& a, const RangeB& b) noexcept {
+    const VectorView view_a(a);
+    const VectorView view_b(b);
+    using Element = typename decltype(view_a)::value_type;
+    static_assert(std::is_same_v<Element, typename decltype(view_b)::value_type>, "element types differ");
+    detail::CheckSimdElement<Element>();
+    assert(view_a.Size() == view_b.Size());
+    return detail::Dispatch([&](auto kernels) {
+        return kernels.Dot(view_a.Data(), view_b.Data(), view_a.Size());
+    });
+}
+
+// Наименьший элемент непустой последовательности
+template <typename Range>
+auto Min(const Range& range) noexcept {
+    const VectorView view(range);
+    detail::CheckSimdElement<typename decltype(view)::value_type>();
+    assert(!view.Empty());
+    return detail::Dispatch([&](auto kernels) {
+        return kernels.Min(view.Data(), view.Size());
+    });
+}
+
+// Наибольший элемент непустой последовательности
+template <typename Range>
+auto Max(const Range& range) noexcept {
+    const VectorView view(range);
+    detail::CheckSimdElement<typename decltype(view)::value_type>();
+    assert(!view.Empty());
+    return detail::Dispatch([&](auto kernels) {
+        return kernels.Max(view.Data(), view.Size());
+    });
+}
+
+// Индекс первого элемента, равного value, или Size(), если такого нет
+template <typename Range, typename T>
+size_t Find(const Range& range, T value) noexcept {
+    const VectorView view(range);
+    using Element = typename decltype(view)::value_type;
+    detail::CheckSimdElement<Element>();
+    return detail::Dispatch([&](auto kernels) {
+        return kernels.Find(view.Data(), view.Size(), static_cast<Element>(value));
+    });
+}
+
+template <typename Range, typename T>
+size_t Count(const Range& range, T value) noexcept {
+    const VectorView view(range);
+    using Element = typename decltype(view)::value_type;
+    detail::CheckSimdElement<Element>();
+    return detail::Dispatch([&](auto kernels) {
+        return kernels.Count(view.Data(), view.Size(), static_cast<Element>(value));
+    });
+}
+
+// dst[i] = op(src[i]). Простой op, например [](float x) { return x * 2 + 1; }, встраивается
+// в ядро и векторизуется компилятором под выбранный набор инструкций. dst может совпадать с src
+template <typename SrcRange, typename DstRange, typename Operation>
+void Transform(const SrcRange& src, DstRange&& dst, Operation op) {
+    const VectorView src_view(src);
+    const auto dst_view = VectorView(dst);
+    using Element = typename decltype(src_view)::value_type;
+    static_assert(std::is_same_v<Element, typename decltype(dst_view)::value_type>, "element types differ");
+    detail::CheckSimdElement<Element>();
+    assert(src_view.Size() == dst_view.Size());
+    detail::Dispatch([&](auto kernels) {
+        kernels.Transform(src_view.Data(), src_view.Size(), dst_view.Data(), op);
+    });
+}
+
+// Поэлементное сравнение по operator== элементов: для чисел с плавающей точкой NaN не равен себе,
+// а 0.0 равен -0.0
+template <typename RangeA, typename RangeB>
+bool Equal(const RangeA& a, const RangeB& b) noexcept {
+    const VectorView view_a(a);
+    const VectorView view_b(b);
+    using Element = typename decltype(view_a)::value_type;
+    static_assert(std::is_same_v<Element, typename decltype(view_b)::value_type>, "element types differ");
+    detail::CheckSimdElement<Element>();
+    return view_a.Size() == view_b.Size() && detail::Dispatch([&](auto kernels) {
+               return kernels.Equal(view_a.Data(), view_b.Data(), view_a.Size());
+           });
+}
+
+}  // namespace simd
@@ -0,0 +1,182 @@
+// Сравнение SIMD-алгоритмов simd.h со скалярными ядрами на каждом уровне, который поддерживает
+// процессор. Размеры покрывают пустой диапазон, один элемент, lanes - 1, lanes и lanes + 1
+// для ширины каждого набора инструкций и большой массив; данные начинаются с невыровненного адреса.
+//
+// Сборка и запуск: g++ -std=c++17 -Wall -Wextra simd_test.cpp -o simd_test && ./simd_test
+#include "simd.h"
+#include "vector.h"
+#include "views.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if (!(cond)) {                                                              \
+            std::fprintf(stderr, "%s:%d: %s failed (level %d, %s, size %zu)\n",     \
+                         __FILE__, __LINE__, #cond, static_cast<int>(simd::ActiveLevel()), \
+                         type_name, n);                                             \
+            std::abort();                                                           \
+        }                                                                           \
+    } while (false)
+
+namespace {
+
+using simd::detail::ScalarKernels;
+
+constexpr size_t kLargeSize = 1027;
+
+// Значения - небольшие целые, поэтому суммы и скалярные произведения float и double точны
+// при любом порядке сложения и сравниваются с эталоном без допуска
+template <typename T>
+T Value(size_t i) {
+    return static_cast<T>(static_cast<int>(i * 7 % 17) - 8);
+}
+
+// Размеры вокруг ширины регистра 16, 32 и 64 байт
+template <typename T>
+Vector<size_t> Sizes() {
+    Vector<size_t> sizes;
+    sizes.PushBack(0);
+    sizes.PushBack(1);
+    for (size_t bytes : {16, 32, 64}) {
+        const size_t lanes = bytes / sizeof(T);
+        sizes.PushBack(lanes - 1);
+        sizes.PushBack(lanes);
+        sizes.PushBack(lanes + 1);
+    }
+    sizes.PushBack(kLargeSize);
+    return sizes;
+}
+
+template <typename T>
+void CheckKernels(const char* type_name) {
+    for (const size_t n : Sizes<T>()) {
+        // Первый элемент буфера пропускается, чтобы начало данных не было выровнено
+        Vector<T> a_buf(n + 1);
+        Vector<T> b_buf(n + 1);
+        Vector<T> dst_buf(n + 1);
+        Vector<T> expected(n);
+        const VectorView<T> a(a_buf.Data() + 1, n);
+        const VectorView<T> b(b_buf.Data() + 1, n);
+        const VectorView<T> dst(dst_buf.Data() + 1, n);
+        for (size_t i = 0; i < n; ++i) {
+            a[i] = Value<T>(i);
+            b[i] = Value<T>(i * 3 + 1);
+        }
+
+        simd::Fill(dst, T(5));
+        ScalarKernels::Fill(expected.Data(), n, T(5));
+        CHECK(ScalarKernels::Equal(dst.Data(), expected.Data(), n));
+
+        CHECK(simd::Sum(a) == ScalarKernels::Sum(a.Data(), n));
+        CHECK(simd::Dot(a, b) == ScalarKernels::Dot(a.Data(), b.Data(), n));
+        if (n != 0) {
+            CHECK(simd::Min(a) == ScalarKernels::Min(a.Data(), n));
+            CHECK(simd::Max(a) == ScalarKernels::Max(a.Data(), n));
+            // Экстремум в последнем элементе попадает в хвост после векторной части
+            a[n - 1] = T(-100);
+            CHECK(simd::Min(a) == ScalarKernels::Min(a.Data(), n));
+            a[n - 1] = T(100);
+            CHECK(simd::Max(a) == ScalarKernels::Max(a.Data(), n));
+            a[n - 1] = Value<T>(n - 1);
+        }
+
+        for (const T value : {T(-8), T(0), T(100)}) {
+            CHECK(simd::Find(a, value) == ScalarKernels::Find(a.Data(), n, value));
+            CHECK(simd::Count(a, value) == ScalarKernels::Count(a.Data(), n, value));
+        }
+        if (n != 0) {
+            a[n - 1] = T(100);
+            CHECK(simd::Find(a, T(100)) == n - 1);
+            CHECK(simd::Count(a, T(100)) == 1);
+            a[n - 1] = Value<T>(n - 1);
+        }
+
+        auto op = [](T x) { return static_cast<T>(x * 2 + 1); };
+        simd::Transform(a, dst, op);
+        ScalarKernels::Transform(a.Data(), n, expected.Data(), op);
+        CHECK(ScalarKernels::Equal(dst.Data(), expected.Data(), n));
+
+        simd::Transform(a, dst, [](T x) { return x; });
+        CHECK(simd::Equal(a, dst) == ScalarKernels::Equal(a.Data(), dst.Data(), n));
+        CHECK(simd::Equal(a, dst));
+        CHECK(simd::Equal(a, b) == ScalarKernels::Equal(a.Data(), b.Data(), n));
+        if (n != 0) {
+            dst[n - 1] = T(100);
+            CHECK(!simd::Equal(a, dst));
+            CHECK(!simd::Equal(a.Subview(0, n - 1), dst));
+        }
+    }
+}
+
+// Equal сравнивает по operator== элементов, а не по байтам
+template <typename T>
+void CheckFloatEquality(const char* type_name) {
+    const size_t n = kLargeSize;
+    Vector<T> a(n);
+    Vector<T> b(n);
+    a[n / 2] = T(0.0);
+    b[n / 2] = T(-0.0);
+    CHECK(simd::Equal(a, b) && ScalarKernels::Equal(a.Data(), b.Data(), n));
+    a[n - 1] = b[n - 1] = std::numeric_limits<T>::quiet_NaN();
+    CHECK(!simd::Equal(a, b) && !ScalarKernels::Equal(a.Data(), b.Data(), n));
+}
+
+void CheckAllTypes() {
+    CheckKernels<int8_t>("int8_t");
+    CheckKernels<int32_t>("int32_t");
+    CheckKernels<float>("float");
+    CheckKernels<double>("double");
+    CheckFloatEquality<float>("float");
+    CheckFloatEquality<double>("double");
+}
+
+// operator== Vector сравнивает через memcmp типы с уникальным представлением объектов,
+// остальные - поэлементно
+void CheckVectorEquality() {
+    const char* type_name = "int32_t";
+    static_assert(std::has_unique_object_representations_v<int32_t>);
+    for (const size_t n : Sizes<int32_t>()) {
+        Vector<int32_t> a(n);
+        for (size_t i = 0; i < n; ++i) {
+            a[i] = Value<int32_t>(i);
+        }
+        Vector<int32_t> b = a;
+        CHECK(a == b);
+        if (n != 0) {
+            b[n - 1] = 100;
+            CHECK(a != b);
+            b.PopBack();
+            CHECK(a != b);
+        }
+    }
+
+    type_name = "float";
+    static_assert(!std::has_unique_object_representations_v<float>);
+    size_t n = kLargeSize;
+    Vector<float> x(n);
+    Vector<float> y(n);
+    y[n - 1] = -0.0f;
+    CHECK(x == y);
+    x[0] = y[0] = std::numeric_limits<float>::quiet_NaN();
+    CHECK(x != y);
+}
+
+}  // namespace
+
+int main() {
+    const int detected = static_cast<int>(simd::DetectedLevel());
+    for (int level = static_cast<int>(simd::Level::kScalar); level <= detected; ++level) {
+        simd::SetLevel(static_cast<simd::Level>(level));
+        // На AArch64 SetLevel заменяет недоступные уровни x86 на NEON, он проверяется на своей итерации
+        if (level != static_cast<int>(simd::Level::kScalar) && static_cast<int>(simd::ActiveLevel()) != level) {
+            continue;
+        }
+        CheckAllTypes();
+    }
+    CheckVectorEquality();
+    std::puts("simd test passed");
+}
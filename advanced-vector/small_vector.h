@@ -0,0 +1,293 @@
+#pragma once
+#include "vector.h"
+
+// Вектор, хранящий до N элементов внутри объекта без обращения к куче.
+// При превышении N элементы переносятся в RawMemory и дальше вектор растёт так же, как Vector
+template <typename T, size_t N, typename Growth = DoublingGrowth>
+class SmallVector {
+    static_assert(N > 0, "inline capacity must be positive");
+
+    static constexpr bool kRelocateBytes = kIsTriviallyRelocatable<T>;
+
+public:
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    iterator begin() noexcept {
+        return Data();
+    }
+    iterator end() noexcept {
+        return Data() + size_;
+    }
+    const_iterator begin() const noexcept {
+        return Data();
+    }
+    const_iterator end() const noexcept {
+        return Data() + size_;
+    }
+    const_iterator cbegin() const noexcept {
+        return Data();
+    }
+    const_iterator cend() const noexcept {
+        return Data() + size_;
+    }
+
+    SmallVector() = default;
+
+    explicit SmallVector(size_t size) {
+        Reserve(size);
+        std::uninitialized_value_construct_n(Data(), size);
+        size_ = size;
+    }
+
+    SmallVector(const SmallVector& other) {
+        Reserve(other.size_);
+        std::uninitialized_copy_n(other.Data(), other.size_, Data());
+        size_ = other.size_;
+    }
+
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (other.IsInline()) {
+            std::uninitialized_move_n(other.Data(), other.size_, Data());
+            size_ = other.size_;
+            other.Clear();
+        } else {
+            heap_ = std::move(other.heap_);
+            size_ = std::exchange(other.size_, 0);
+        }
+    }
+
+    ~SmallVector() {
+        std::destroy_n(Data(), size_);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return IsInline() ? N : heap_.Capacity();
+    }
+
+    // Элементы хранятся внутри объекта
+    bool IsInline() const noexcept {
+        return heap_.Capacity() == 0;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SmallVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+        RawMemory<T> new_data(new_capacity);
+        SwapCopy(new_data);
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            std::destroy_n(Data() + new_size, size_ - new_size);
+        } else {
+            Reserve(new_size);
+            std::uninitialized_value_construct_n(Data() + size_, new_size - size_);
+        }
+        size_ = new_size;
+    }
+
+    void Clear() noexcept {
+        std::destroy_n(Data(), size_);
+        size_ = 0;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            RawMemory<T> new_data(NextCapacity(size_ + 1));
+            new (new_data + size_) T(std::forward<Args>(args)...);
+            try {
+                SwapCopy(new_data);
+            } catch (...) {
+                std::destroy_at(new_data + size_);
+                throw;
+            }
+        } else {
+            new (Data() + size_) T(std::forward<Args>(args)...);
+        }
+        ++size_;
+        return Data()[size_ - 1];
+    }
+
+    void PopBack() {
+        if (size_ == 0) {
+            return;
+        }
+        std::destroy_at(Data() + size_ - 1);
+        --size_;
+    }
+
+    iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args) {
+        if (pos < begin() || pos > end()) {
+            return end();
+        }
+        const size_t idx = pos - begin();
+        if (size_ == Capacity()) {
+            RawMemory<T> new_data(NextCapacity(size_ + 1));
+            new (new_data + idx) T(std::forward<Args>(args)...);
+            if constexpr (kRelocateBytes) {
+                detail::RelocateBytes(Data(), idx, new_data.GetAddress());
+                detail::RelocateBytes(Data() + idx, size_ - idx, new_data + idx + 1);
+            } else {
+                try {
+                    detail::UninitializedTransferN(Data(), idx, new_data.GetAddress());
+                } catch (...) {
+                    std::destroy_at(new_data + idx);
+                    throw;
+                }
+                try {
+                    detail::UninitializedTransferN(Data() + idx, size_ - idx, new_data + idx + 1);
+                } catch (...) {
+                    std::destroy_n(new_data.GetAddress(), idx + 1);
+                    throw;
+                }
+                std::destroy_n(Data(), size_);
+            }
+            heap_.Swap(new_data);
+        } else if (idx == size_) {
+            new (Data() + idx) T(std::forward<Args>(args)...);
+        } else if constexpr (kRelocateBytes) {
+            detail::RelocationSlot<T> slot(std::forward<Args>(args)...);
+            detail::RelocateBytesOverlapping(Data() + idx, size_ - idx, Data() + idx + 1);
+            slot.RelocateTo(Data() + idx);
+        } else {
+            T tmp(std::forward<Args>(args)...);
+            new (Data() + size_) T(std::move(Data()[size_ - 1]));
+            std::move_backward(Data() + idx, Data() + size_ - 1, Data() + size_);
+            Data()[idx] = std::move(tmp);
+        }
+        ++size_;
+        return begin() + idx;
+    }
+
+    iterator Erase(const_iterator pos) {
+        if (pos < begin() || pos >= end()) {
+            return end();
+        }
+        const size_t idx = pos - begin();
+        if constexpr (kRelocateBytes) {
+            std::destroy_at(Data() + idx);
+            detail::RelocateBytesOverlapping(Data() + idx + 1, size_ - idx - 1, Data() + idx);
+        } else {
+            std::move(Data() + idx + 1, Data() + size_, Data() + idx);
+            std::destroy_at(Data() + size_ - 1);
+        }
+        --size_;
+        return begin() + idx;
+    }
+
+    SmallVector& operator=(const SmallVector& rhs) {
+        if (this != &rhs) {
+            if (rhs.size_ > Capacity()) {
+                SmallVector rhs_copy(rhs);
+                Swap(rhs_copy);
+            } else {
+                const size_t cp_size = std::min(size_, rhs.size_);
+                std::copy_n(rhs.Data(), cp_size, Data());
+                if (size_ > rhs.size_) {
+                    std::destroy_n(Data() + cp_size, size_ - cp_size);
+                } else {
+                    std::uninitialized_copy_n(rhs.Data() + cp_size, rhs.size_ - cp_size, Data() + cp_size);
+                }
+                size_ = rhs.size_;
+            }
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>
+                                                       && std::is_nothrow_move_assignable_v<T>) {
+        if (this != &rhs) {
+            if (!rhs.IsInline()) {
+                Clear();
+                heap_.Swap(rhs.heap_);
+                std::swap(size_, rhs.size_);
+            } else {
+                const size_t mv_size = std::min(size_, rhs.size_);
+                std::move(rhs.Data(), rhs.Data() + mv_size, Data());
+                if (size_ > rhs.size_) {
+                    std::destroy_n(Data() + mv_size, size_ - mv_size);
+                } else {
+                    std::uninitialized_move_n(rhs.Data() + mv_size, rhs.size_ - mv_size, Data() + mv_size);
+                }
+                size_ = rhs.size_;
+                rhs.Clear();
+            }
+        }
+        return *this;
+    }
+
+    // Если оба вектора хранят элементы в куче, обмен выполняется за O(1), иначе - поэлементно
+    void Swap(SmallVector& other) noexcept(std::is_nothrow_move_constructible_v<T>
+                                           && std::is_nothrow_move_assignable_v<T>) {
+        if (!IsInline() && !other.IsInline()) {
+            heap_.Swap(other.heap_);
+            std::swap(size_, other.size_);
+        } else {
+            SmallVector tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+    }
+
+private:
+    T* Data() noexcept {
+        return IsInline() ? std::launder(reinterpret_cast<T*>(inline_)) : heap_.GetAddress();
+    }
+
+    const T* Data() const noexcept {
+        return const_cast<SmallVector&>(*this).Data();
+    }
+
+    size_t NextCapacity(size_t required) const noexcept {
+        return Growth::NextCapacity(Capacity(), required, sizeof(T));
+    }
+
+    // Переносит элементы в new_data и делает его текущим буфером. Прежний буфер
+    // (если он был в куче) оказывается в new_data и освобождается вместе с ним
+    void SwapCopy(RawMemory<T>& new_data) {
+        if constexpr (kRelocateBytes) {
+            detail::RelocateBytes(Data(), size_, new_data.GetAddress());
+        } else {
+            detail::UninitializedTransferN(Data(), size_, new_data.GetAddress());
+            std::destroy_n(Data(), size_);
+        }
+        heap_.Swap(new_data);
+    }
+
+    RawMemory<T> heap_;
+    alignas(T) unsigned char inline_[N * sizeof(T)];
+    size_t size_ = 0;
+};
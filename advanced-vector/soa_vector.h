@@ -0,0 +1,343 @@
+#pragma once
+#include "views.h"
+
+#include <tuple>
+
+// Вектор записей, хранящий каждое поле в отдельном столбце RawMemory (structure of arrays).
+// Обход одного-двух полей читает только их столбцы, а Column<I>() отдаёт непрерывный столбец
+// для векторизованных вычислений. Все столбцы имеют общую вместимость и растут вместе
+// согласно Growth. Гарантии безопасности исключений те же, что у Vector
+template <typename Tuple, typename Growth = DoublingGrowth>
+class SoAVector;
+
+template <typename... Fields, typename Growth>
+class SoAVector<std::tuple<Fields...>, Growth> {
+    static_assert(sizeof...(Fields) > 0, "SoAVector needs at least one field");
+
+    using Columns = std::tuple<RawMemory<Fields>...>;
+    using Indices = std::index_sequence_for<Fields...>;
+
+    template <size_t I>
+    using FieldAt = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    template <size_t I>
+    using Index = std::integral_constant<size_t, I>;
+
+public:
+    using value_type = std::tuple<Fields...>;
+    using reference = std::tuple<Fields&...>;
+    using const_reference = std::tuple<const Fields&...>;
+
+    SoAVector() = default;
+
+    explicit SoAVector(size_t size)
+        : columns_(MakeColumns(size, Indices{})) {
+        BuildColumns(
+            [this, size](auto i) {
+                std::uninitialized_value_construct_n(Data<i>(), size);
+            },
+            [this, size](auto i) {
+                std::destroy_n(Data<i>(), size);
+            });
+        size_ = size;
+    }
+
+    SoAVector(const SoAVector& other)
+        : columns_(MakeColumns(other.size_, Indices{})) {
+        BuildColumns(
+            [this, &other](auto i) {
+                std::uninitialized_copy_n(other.Data<i>(), other.size_, Data<i>());
+            },
+            [this, &other](auto i) {
+                std::destroy_n(Data<i>(), other.size_);
+            });
+        size_ = other.size_;
+    }
+
+    SoAVector(SoAVector&& other) noexcept
+        : columns_(std::move(other.columns_))
+        , size_(std::exchange(other.size_, 0)) {
+    }
+
+    ~SoAVector() {
+        DestroyAll();
+    }
+
+    SoAVector& operator=(const SoAVector& rhs) {
+        if (this != &rhs) {
+            SoAVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    SoAVector& operator=(SoAVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Swap(rhs);
+        }
+        return *this;
+    }
+
+    void Swap(SoAVector& other) noexcept {
+        ForEachColumn([this, &other](auto i) {
+            std::get<i>(columns_).Swap(std::get<i>(other.columns_));
+        });
+        std::swap(size_, other.size_);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return std::get<0>(columns_).Capacity();
+    }
+
+    // Непрерывный столбец поля I
+    template <size_t I>
+    FieldAt<I>* Data() noexcept {
+        return std::get<I>(columns_).GetAddress();
+    }
+
+    template <size_t I>
+    const FieldAt<I>* Data() const noexcept {
+        return std::get<I>(columns_).GetAddress();
+    }
+
+    template <size_t I>
+    VectorView<FieldAt<I>> Column() noexcept {
+        return {Data<I>(), size_};
+    }
+
+    template <size_t I>
+    VectorView<const FieldAt<I>> Column() const noexcept {
+        return {Data<I>(), size_};
+    }
+
+    template <size_t I>
+    FieldAt<I>& Get(size_t index) noexcept {
+        assert(index < size_);
+        return Data<I>()[index];
+    }
+
+    template <size_t I>
+    const FieldAt<I>& Get(size_t index) const noexcept {
+        assert(index < size_);
+        return Data<I>()[index];
+    }
+
+    // Кортеж ссылок на поля записи index
+    reference operator[](size_t index) noexcept {
+        assert(index < size_);
+        return RowAt<reference>(*this, index, Indices{});
+    }
+
+    const_reference operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return RowAt<const_reference>(*this, index, Indices{});
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+        Columns new_columns = MakeColumns(new_capacity, Indices{});
+        TransferTo(new_columns);
+        SwapColumns(new_columns);
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            ForEachColumn([this, new_size](auto i) {
+                std::destroy_n(Data<i>() + new_size, size_ - new_size);
+            });
+        } else {
+            Reserve(new_size);
+            BuildColumns(
+                [this, new_size](auto i) {
+                    std::uninitialized_value_construct_n(Data<i>() + size_, new_size - size_);
+                },
+                [this, new_size](auto i) {
+                    std::destroy_n(Data<i>() + size_, new_size - size_);
+                });
+        }
+        size_ = new_size;
+    }
+
+    void PushBack(const value_type& row) {
+        std::apply(
+            [this](const Fields&... fields) {
+                EmplaceBack(fields...);
+            },
+            row);
+    }
+
+    void PushBack(value_type&& row) {
+        std::apply(
+            [this](Fields&... fields) {
+                EmplaceBack(std::move(fields)...);
+            },
+            row);
+    }
+
+    // Конструирует поле I новой записи из I-го аргумента. Аргументы могут ссылаться на элементы вектора:
+    // при росте новая запись создаётся до переноса прежних
+    template <typename... Args>
+    reference EmplaceBack(Args&&... args) {
+        static_assert(sizeof...(Args) == sizeof...(Fields), "one argument per field expected");
+        auto refs = std::forward_as_tuple(std::forward<Args>(args)...);
+        const auto construct_in = [this, &refs](Columns& columns) {
+            BuildColumns(
+                [this, &refs, &columns](auto i) {
+                    new (std::get<i>(columns) + size_) FieldAt<i>(std::get<i>(std::move(refs)));
+                },
+                [this, &columns](auto i) {
+                    std::destroy_at(std::get<i>(columns) + size_);
+                });
+        };
+        if (size_ == Capacity()) {
+            Columns new_columns = MakeColumns(Growth::NextCapacity(Capacity(), size_ + 1, RowSize()), Indices{});
+            construct_in(new_columns);
+            try {
+                TransferTo(new_columns);
+            } catch (...) {
+                ForEachColumn([this, &new_columns](auto i) {
+                    std::destroy_at(std::get<i>(new_columns) + size_);
+                });
+                throw;
+            }
+            SwapColumns(new_columns);
+        } else {
+            construct_in(columns_);
+        }
+        ++size_;
+        return (*this)[size_ - 1];
+    }
+
+    void PopBack() noexcept {
+        if (size_ == 0) {
+            return;
+        }
+        --size_;
+        ForEachColumn([this](auto i) {
+            std::destroy_at(Data<i>() + size_);
+        });
+    }
+
+    // Удаляет записи [first, last), сдвигая хвост каждого столбца. Сначала сдвигаются столбцы,
+    // перемещение в которых может выбросить исключение, и только после всех сдвигов разрушаются
+    // хвосты: исключение оставляет все size_ записей живыми, как Erase у Vector
+    void Erase(size_t first, size_t last) {
+        assert(first <= last && last <= size_);
+        if (first == last) {
+            return;
+        }
+        ForEachColumn([this, first, last](auto i) {
+            using Field = FieldAt<i>;
+            if constexpr (!kIsTriviallyRelocatable<Field>) {
+                Field* data = Data<i>();
+                std::move(data + last, data + size_, data + first);
+            }
+        });
+        ForEachColumn([this, first, last](auto i) {
+            using Field = FieldAt<i>;
+            Field* data = Data<i>();
+            if constexpr (kIsTriviallyRelocatable<Field>) {
+                std::destroy(data + first, data + last);
+                detail::RelocateBytesOverlapping(data + last, size_ - last, data + first);
+            } else {
+                std::destroy(data + size_ - (last - first), data + size_);
+            }
+        });
+        size_ -= last - first;
+    }
+
+    void Erase(size_t index) {
+        Erase(index, index + 1);
+    }
+
+    void Clear() noexcept {
+        DestroyAll();
+        size_ = 0;
+    }
+
+private:
+    static constexpr size_t RowSize() noexcept {
+        return (sizeof(Fields) + ...);
+    }
+
+    template <size_t... Is>
+    static Columns MakeColumns(size_t capacity, std::index_sequence<Is...>) {
+        return Columns(RawMemory<FieldAt<Is>>(capacity)...);
+    }
+
+    template <typename Row, typename Self, size_t... Is>
+    static Row RowAt(Self& self, size_t index, std::index_sequence<Is...>) noexcept {
+        return Row(self.template Data<Is>()[index]...);
+    }
+
+    template <typename F>
+    void ForEachColumn(F f) {
+        ForEachColumn(f, Indices{});
+    }
+
+    template <typename F, size_t... Is>
+    static void ForEachColumn(F& f, std::index_sequence<Is...>) {
+        (f(Index<Is>{}), ...);
+    }
+
+    // Вызывает build для столбцов по порядку. Если build для столбца выбросил исключение,
+    // для уже обработанных столбцов в обратном порядке вызывается undo
+    template <size_t I = 0, typename Build, typename Undo>
+    void BuildColumns(Build build, Undo undo) {
+        if constexpr (I < sizeof...(Fields)) {
+            build(Index<I>{});
+            try {
+                BuildColumns<I + 1>(build, undo);
+            } catch (...) {
+                undo(Index<I>{});
+                throw;
+            }
+        }
+    }
+
+    // Переносит записи в new_columns. Если перенос не удался, new_columns не содержит живых записей
+    void TransferTo(Columns& new_columns) {
+        BuildColumns(
+            [this, &new_columns](auto i) {
+                using Field = FieldAt<i>;
+                if constexpr (kIsTriviallyRelocatable<Field>) {
+                    detail::RelocateBytes(Data<i>(), size_, std::get<i>(new_columns).GetAddress());
+                } else {
+                    detail::UninitializedTransferN(Data<i>(), size_, std::get<i>(new_columns).GetAddress());
+                }
+            },
+            [this, &new_columns](auto i) {
+                using Field = FieldAt<i>;
+                if constexpr (kIsTriviallyRelocatable<Field>) {
+                    // Байты столбца остались и в старом буфере, там объекты по-прежнему живы
+                } else {
+                    std::destroy_n(std::get<i>(new_columns).GetAddress(), size_);
+                }
+            });
+    }
+
+    // Делает new_columns текущими столбцами. Прежние записи, перенесённые не побайтово, разрушаются
+    void SwapColumns(Columns& new_columns) noexcept {
+        ForEachColumn([this, &new_columns](auto i) {
+            if constexpr (!kIsTriviallyRelocatable<FieldAt<i>>) {
+                std::destroy_n(Data<i>(), size_);
+            }
+            std::get<i>(columns_).Swap(std::get<i>(new_columns));
+        });
+    }
+
+    void DestroyAll() noexcept {
+        ForEachColumn([this](auto i) {
+            std::destroy_n(Data<i>(), size_);
+        });
+    }
+
+    Columns columns_;
+    size_t size_ = 0;
+};
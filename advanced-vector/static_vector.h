@@ -0,0 +1,406 @@
+#pragma once
+#include "vector.h"
+
+#include <initializer_list>
+#include <type_traits>
+
+// В C++20 StaticVector тривиальных типов доступен в константных выражениях
+#if defined(__cpp_constexpr) && __cpp_constexpr >= 201907L && defined(__cpp_lib_is_constant_evaluated)
+#define ADVANCED_VECTOR_CONSTEXPR20 constexpr
+#define ADVANCED_VECTOR_HAS_CONSTEXPR20 1
+#else
+#define ADVANCED_VECTOR_CONSTEXPR20
+#define ADVANCED_VECTOR_HAS_CONSTEXPR20 0
+#endif
+
+namespace detail {
+
+enum class StaticStorageKind {
+    // Тривиальные T: обычный массив, вектор тривиально копируется и разрушается
+    kTrivial,
+    // Тривиально копируемые и разрушаемые T, например с инициализаторами полей: сырая память,
+    // копируемая целиком, вектор тривиально копируется и разрушается
+    kTriviallyCopyable,
+    // Тривиально разрушаемые T: сырая память, вектор тривиально разрушается
+    kTriviallyDestructible,
+    kGeneral,
+};
+
+template <typename T>
+inline constexpr StaticStorageKind kStaticStorageKindOf =
+    std::is_trivial_v<T> && std::is_default_constructible_v<T> && std::is_move_assignable_v<T>
+        ? StaticStorageKind::kTrivial
+    : std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+        ? StaticStorageKind::kTriviallyCopyable
+        : std::is_trivially_destructible_v<T> ? StaticStorageKind::kTriviallyDestructible
+                                              : StaticStorageKind::kGeneral;
+
+template <typename T, size_t N, StaticStorageKind Kind = kStaticStorageKindOf<T>>
+class StaticStorage {
+protected:
+    ADVANCED_VECTOR_CONSTEXPR20 StaticStorage() noexcept {
+#if ADVANCED_VECTOR_HAS_CONSTEXPR20
+        // Результат константного выражения не может содержать неинициализированных элементов
+        if (std::is_constant_evaluated()) {
+            for (T& elem : elems_) {
+                elem = T();
+            }
+        }
+#endif
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR20 T* Elements() noexcept {
+        return elems_;
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR20 const T* Elements() const noexcept {
+        return elems_;
+    }
+
+    T elems_[N];
+    size_t size_ = 0;
+};
+
+template <typename T, size_t N>
+class StaticStorage<T, N, StaticStorageKind::kTriviallyCopyable> {
+protected:
+    StaticStorage() noexcept = default;
+
+    T* Elements() noexcept {
+        return std::launder(reinterpret_cast<T*>(bytes_));
+    }
+
+    const T* Elements() const noexcept {
+        return std::launder(reinterpret_cast<const T*>(bytes_));
+    }
+
+    alignas(T) unsigned char bytes_[sizeof(T) * N];
+    size_t size_ = 0;
+};
+
+template <typename T, size_t N>
+class StaticStorage<T, N, StaticStorageKind::kTriviallyDestructible>
+    : public StaticStorage<T, N, StaticStorageKind::kTriviallyCopyable> {
+    using Base = StaticStorage<T, N, StaticStorageKind::kTriviallyCopyable>;
+
+protected:
+    using Base::Elements;
+    using Base::size_;
+
+    StaticStorage() noexcept = default;
+
+    StaticStorage(const StaticStorage& other)
+        : Base() {
+        std::uninitialized_copy_n(other.Elements(), other.size_, Elements());
+        size_ = other.size_;
+    }
+
+    // Перемещает элементы по одному; исходный вектор сохраняет размер, как std::array
+    StaticStorage(StaticStorage&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : Base() {
+        std::uninitialized_move_n(other.Elements(), other.size_, Elements());
+        size_ = other.size_;
+    }
+
+    StaticStorage& operator=(const StaticStorage& rhs) {
+        if (this != &rhs) {
+            AssignFrom(rhs.Elements(), rhs.size_);
+        }
+        return *this;
+    }
+
+    StaticStorage& operator=(StaticStorage&& rhs) noexcept(std::is_nothrow_move_assignable_v<T>
+                                                           && std::is_nothrow_move_constructible_v<T>) {
+        if (this != &rhs) {
+            AssignFrom(std::make_move_iterator(rhs.Elements()), rhs.size_);
+        }
+        return *this;
+    }
+
+private:
+    // Присваивает общую часть и достраивает или разрушает остаток
+    template <typename It>
+    void AssignFrom(It src, size_t count) {
+        T* elems = Elements();
+        const size_t common = std::min(size_, count);
+        std::copy_n(src, common, elems);
+        if (count > size_) {
+            std::uninitialized_copy_n(src + size_, count - size_, elems + size_);
+        } else {
+            std::destroy_n(elems + count, size_ - count);
+        }
+        size_ = count;
+    }
+};
+
+template <typename T, size_t N>
+class StaticStorage<T, N, StaticStorageKind::kGeneral>
+    : public StaticStorage<T, N, StaticStorageKind::kTriviallyDestructible> {
+    using Base = StaticStorage<T, N, StaticStorageKind::kTriviallyDestructible>;
+
+protected:
+    StaticStorage() noexcept = default;
+    StaticStorage(const StaticStorage&) = default;
+    StaticStorage(StaticStorage&&) = default;
+    StaticStorage& operator=(const StaticStorage&) = default;
+    StaticStorage& operator=(StaticStorage&&) = default;
+
+    ~StaticStorage() {
+        std::destroy_n(this->Elements(), this->size_);
+    }
+};
+
+}  // namespace detail
+
+// Вектор вместимостью N с элементами внутри объекта: без кучи и без перевыделений.
+// Повторяет интерфейс Vector; добавление в заполненный вектор - нарушение предусловия (assert),
+// TryEmplaceBack проверяет место сам. Для тривиально разрушаемых T вектор тривиально разрушается,
+// для тривиально копируемых - ещё и тривиально копируется. StaticVector тривиального T в C++20
+// доступен в константных выражениях:
+//     constexpr auto kSquares = [] {
+//         StaticVector<int, 16> table;
+//         for (int i = 0; i < 16; ++i) {
+//             table.PushBack(i * i);
+//         }
+//         return table;
+//     }();
+template <typename T, size_t N>
+class StaticVector : private detail::StaticStorage<T, N> {
+    static_assert(N > 0, "capacity must be positive");
+
+    using Storage = detail::StaticStorage<T, N>;
+
+    // Элементы лежат в обычном массиве и создаются присваиванием: так работают константные выражения
+    static constexpr bool kPlainArray = detail::kStaticStorageKindOf<T> == detail::StaticStorageKind::kTrivial;
+    static constexpr bool kRelocateBytes = !kPlainArray && kIsTriviallyRelocatable<T>;
+
+    using Storage::size_;
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    ADVANCED_VECTOR_CONSTEXPR20 iterator begin() noexcept {
+        return Data();
+    }
+    ADVANCED_VECTOR_CONSTEXPR20 iterator end() noexcept {
+        return Data() + size_;
+    }
+    ADVANCED_VECTOR_CONSTEXPR20 const_iterator begin() const noexcept {
+        return Data();
+    }
+    ADVANCED_VECTOR_CONSTEXPR20 const_iterator end() const noexcept {
+        return Data() + size_;
+    }
+    ADVANCED_VECTOR_CONSTEXPR20 const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    ADVANCED_VECTOR_CONSTEXPR20 const_iterator cend() const noexcept {
+        return end();
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR20 StaticVector() noexcept = default;
+
+    ADVANCED_VECTOR_CONSTEXPR20 explicit StaticVector(size_t size) {
+        Resize(size);
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR20 StaticVector(size_t size, const T& value) {
+        assert(size <= N);
+        for (size_t i = 0; i < size; ++i) {
+            EmplaceBack(value);
+        }
+    }
+
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    ADVANCED_VECTOR_CONSTEXPR20 StaticVector(InputIt first, InputIt last) {
+        for (; first != last; ++first) {
+            EmplaceBack(*first);
+        }
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR20 StaticVector(std::initializer_list<T> values)
+        : StaticVector(values.begin(), values.end()) {
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR20 T* Data() noexcept {
+        return this->Elements();
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR20 const T* Data() const noexcept {
+        return this->Elements();
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR20 size_t Size() const noexcept {
+        return size_;
+    }
+
+    static constexpr size_t Capacity() noexcept {
+        return N;
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR20 const T& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR20 T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR20 void Resize(size_t new_size) {
+        assert(new_size <= N);
+        while (size_ < new_size) {
+            EmplaceBack();
+        }
+        while (size_ > new_size) {
+            PopBack();
+        }
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR20 void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR20 void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    template <typename... Args>
+    ADVANCED_VECTOR_CONSTEXPR20 T& EmplaceBack(Args&&... args) {
+        assert(size_ < N);
+        T& elem = ConstructAt(Data() + size_, std::forward<Args>(args)...);
+        ++size_;
+        return elem;
+    }
+
+    // Возвращает nullptr, если вектор заполнен
+    template <typename... Args>
+    ADVANCED_VECTOR_CONSTEXPR20 T* TryEmplaceBack(Args&&... args) {
+        return size_ < N ? &EmplaceBack(std::forward<Args>(args)...) : nullptr;
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR20 void PopBack() noexcept {
+        if (size_ == 0) {
+            return;
+        }
+        --size_;
+        DestroyN(Data() + size_, 1);
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR20 void Clear() noexcept {
+        DestroyN(Data(), size_);
+        size_ = 0;
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR20 iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR20 iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    template <typename... Args>
+    ADVANCED_VECTOR_CONSTEXPR20 iterator Emplace(const_iterator pos, Args&&... args) {
+        assert(pos >= begin() && pos <= end());
+        assert(size_ < N);
+        const size_t idx = pos - begin();
+        T* data = Data();
+        if (idx == size_) {
+            EmplaceBack(std::forward<Args>(args)...);
+        } else if constexpr (kRelocateBytes) {
+            // Аргументы могут ссылаться на элементы вектора, поэтому элемент создаётся до сдвига
+            detail::RelocationSlot<T> slot(std::forward<Args>(args)...);
+            detail::RelocateBytesOverlapping(data + idx, size_ - idx, data + idx + 1);
+            slot.RelocateTo(data + idx);
+            ++size_;
+        } else {
+            T tmp(std::forward<Args>(args)...);
+            ConstructAt(data + size_, std::move(data[size_ - 1]));
+            ++size_;
+            std::move_backward(data + idx, data + size_ - 2, data + size_ - 1);
+            data[idx] = std::move(tmp);
+        }
+        return begin() + idx;
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR20 iterator Erase(const_iterator pos) {
+        assert(pos >= begin() && pos < end());
+        return Erase(pos, pos + 1);
+    }
+
+    // Удаляет элементы [first, last): хвост сдвигается один раз
+    ADVANCED_VECTOR_CONSTEXPR20 iterator Erase(const_iterator first, const_iterator last) {
+        assert(first >= begin() && first <= last && last <= end());
+        const size_t idx = first - begin();
+        const size_t count = last - first;
+        if (count != 0) {
+            T* data = Data();
+            if constexpr (kRelocateBytes) {
+                std::destroy_n(data + idx, count);
+                detail::RelocateBytesOverlapping(data + idx + count, size_ - idx - count, data + idx);
+            } else {
+                std::move(data + idx + count, data + size_, data + idx);
+                DestroyN(data + size_ - count, count);
+            }
+            size_ -= count;
+        }
+        return begin() + idx;
+    }
+
+    ADVANCED_VECTOR_CONSTEXPR20 void Swap(StaticVector& other) noexcept(std::is_nothrow_swappable_v<T>
+                                                                       && std::is_nothrow_move_constructible_v<T>) {
+        StaticVector& longer = size_ >= other.size_ ? *this : other;
+        StaticVector& shorter = size_ >= other.size_ ? other : *this;
+        const size_t common = shorter.size_;
+        for (size_t i = 0; i < common; ++i) {
+            using std::swap;
+            swap(Data()[i], other.Data()[i]);
+        }
+        for (size_t i = common; i < longer.size_; ++i) {
+            shorter.EmplaceBack(std::move(longer.Data()[i]));
+        }
+        longer.Erase(longer.begin() + common, longer.end());
+    }
+
+    friend ADVANCED_VECTOR_CONSTEXPR20 bool operator==(const StaticVector& lhs, const StaticVector& rhs) {
+        return lhs.size_ == rhs.size_ && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    friend ADVANCED_VECTOR_CONSTEXPR20 bool operator!=(const StaticVector& lhs, const StaticVector& rhs) {
+        return !(lhs == rhs);
+    }
+
+private:
+    template <typename... Args>
+    static ADVANCED_VECTOR_CONSTEXPR20 T& ConstructAt(T* p, Args&&... args) {
+        if constexpr (kPlainArray) {
+            *p = T(std::forward<Args>(args)...);
+            return *p;
+        } else {
+            return *new (p) T(std::forward<Args>(args)...);
+        }
+    }
+
+    static ADVANCED_VECTOR_CONSTEXPR20 void DestroyN(T* p, size_t n) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            std::destroy_n(p, n);
+        }
+    }
+};
+
+namespace detail {
+
+// Инициализатор поля делает тип нетривиальным, но не мешает тривиальному копированию вектора
+struct StaticVectorCopyCheck {
+    int x = 0;
+};
+
+static_assert(std::is_trivially_copyable_v<StaticVector<StaticVectorCopyCheck, 4>>);
+static_assert(std::is_trivially_destructible_v<StaticVector<StaticVectorCopyCheck, 4>>);
+static_assert(std::is_trivially_copyable_v<StaticVector<int, 4>>);
+
+}  // namespace detail
@@ -1,25 +1,525 @@
 #pragma once
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
 #include <new>
 #include <utility>
 #include <memory>
 #include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <limits>
+
+#if __has_include(<span>)
+#include <span>
+#endif
 
 #include <iostream>
 
+// Признак того, что объект можно перенести в другую память побайтовым копированием,
+// не вызывая конструктор перемещения и деструктор исходного объекта.
+// Для собственных типов признак включается специализацией шаблона
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+struct IsTriviallyRelocatable<std::unique_ptr<T>> : std::true_type {};
+
 template <typename T>
-class RawMemory {
-public:    
+inline constexpr bool kIsTriviallyRelocatable = IsTriviallyRelocatable<T>::value;
+
+namespace detail {
+
+// Аллокатор умеет изменять размер блока с сохранением содержимого (как realloc):
+// T* reallocate(T* p, size_t old_n, size_t new_n)
+template <typename Alloc, typename = void>
+struct HasReallocate : std::false_type {};
+
+template <typename Alloc>
+struct HasReallocate<Alloc, std::void_t<decltype(std::declval<Alloc&>().reallocate(
+                                std::declval<typename Alloc::value_type*>(), size_t{}, size_t{}))>>
+    : std::true_type {};
+
+// Побайтово переносит n тривиально переносимых объектов в неинициализированную память dst
+template <typename T>
+void RelocateBytes(T* src, size_t n, T* dst) noexcept {
+    if (n != 0) {
+        std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(T));
+    }
+}
+
+// То же, что RelocateBytes, но диапазоны src и dst могут перекрываться
+template <typename T>
+void RelocateBytesOverlapping(T* src, size_t n, T* dst) noexcept {
+    if (n != 0) {
+        std::memmove(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(T));
+    }
+}
+
+// Конструирует в dst копии n элементов из src. Элементы перемещаются, если перемещение
+// не выбрасывает исключений или копирование недоступно
+template <typename T>
+void UninitializedTransferN(T* src, size_t n, T* dst) {
+    if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+        std::uninitialized_move_n(src, n, dst);
+    } else {
+        std::uninitialized_copy_n(src, n, dst);
+    }
+}
+
+// Временное место под один объект, который затем побайтово переносится в контейнер.
+// Позволяет создать элемент из аргументов, ссылающихся на сам контейнер, до сдвига его элементов
+template <typename T>
+class RelocationSlot {
+public:
+    template <typename... Args>
+    explicit RelocationSlot(Args&&... args) {
+        new (storage_) T(std::forward<Args>(args)...);
+    }
+
+    RelocationSlot(const RelocationSlot&) = delete;
+    RelocationSlot& operator=(const RelocationSlot&) = delete;
+
+    ~RelocationSlot() {
+        if (!relocated_) {
+            std::destroy_at(Get());
+        }
+    }
+
+    void RelocateTo(T* dst) noexcept {
+        RelocateBytes(Get(), 1, dst);
+        relocated_ = true;
+    }
+
+private:
+    T* Get() noexcept {
+        return std::launder(reinterpret_cast<T*>(storage_));
+    }
+
+    alignas(T) unsigned char storage_[sizeof(T)];
+    bool relocated_ = false;
+};
+
+template <typename It>
+using IteratorCategory = typename std::iterator_traits<It>::iterator_category;
+
+template <typename It, typename = void>
+struct IsInputIterator : std::false_type {};
+
+template <typename It>
+struct IsInputIterator<It, std::void_t<IteratorCategory<It>>>
+    : std::is_convertible<IteratorCategory<It>, std::input_iterator_tag> {};
+
+template <typename It, typename = void>
+struct IsForwardIterator : std::false_type {};
+
+template <typename It>
+struct IsForwardIterator<It, std::void_t<IteratorCategory<It>>>
+    : std::is_convertible<IteratorCategory<It>, std::forward_iterator_tag> {};
+
+template <typename It>
+using RequireInputIterator = std::enable_if_t<IsInputIterator<It>::value>;
+
+// Аргументы Emplace - единственный готовый объект T, который можно присвоить без временной копии
+template <typename T, typename... Args>
+inline constexpr bool kIsElementArgument = false;
+
+template <typename T, typename Arg>
+inline constexpr bool kIsElementArgument<T, Arg> = std::is_same_v<std::remove_cv_t<std::remove_reference_t<Arg>>, T>;
+
+// Хранит аллокатор, не занимая места, если он пустой (empty base optimization)
+template <typename Alloc, bool = std::is_empty_v<Alloc> && !std::is_final_v<Alloc>>
+class AllocatorHolder : private Alloc {
+public:
+    AllocatorHolder() = default;
+    explicit AllocatorHolder(const Alloc& alloc) noexcept
+        : Alloc(alloc) {
+    }
+    explicit AllocatorHolder(Alloc&& alloc) noexcept
+        : Alloc(std::move(alloc)) {
+    }
+
+    Alloc& GetAlloc() noexcept {
+        return *this;
+    }
+    const Alloc& GetAlloc() const noexcept {
+        return *this;
+    }
+};
+
+template <typename Alloc>
+class AllocatorHolder<Alloc, false> {
+public:
+    AllocatorHolder() = default;
+    explicit AllocatorHolder(const Alloc& alloc) noexcept
+        : alloc_(alloc) {
+    }
+    explicit AllocatorHolder(Alloc&& alloc) noexcept
+        : alloc_(std::move(alloc)) {
+    }
+
+    Alloc& GetAlloc() noexcept {
+        return alloc_;
+    }
+    const Alloc& GetAlloc() const noexcept {
+        return alloc_;
+    }
+
+private:
+    Alloc alloc_;
+};
+
+}  // namespace detail
+
+// Места, в которых вектор перевыделяет память
+enum class ReallocationSite {
+    kReserve,
+    kEmplaceBack,
+    kEmplace,
+    kInsertRange,
+    kAssignment,
+    kShrink,
+    kCount,
+};
+
+inline const char* ReallocationSiteName(ReallocationSite site) noexcept {
+    switch (site) {
+        case ReallocationSite::kReserve:
+            return "Reserve";
+        case ReallocationSite::kEmplaceBack:
+            return "EmplaceBack";
+        case ReallocationSite::kEmplace:
+            return "Emplace";
+        case ReallocationSite::kInsertRange:
+            return "Insert";
+        case ReallocationSite::kAssignment:
+            return "assignment";
+        case ReallocationSite::kShrink:
+            return "ShrinkToFit";
+        default:
+            return "construction";
+    }
+}
+
+// Защищённый режим (-DADVANCED_VECTOR_HARDENED): operator[] проверяет индекс, итераторы Vector
+// проверяют границы и поколение буфера, а позиции Insert, Emplace и Erase - принадлежность вектору.
+// Как и у std::vector, итераторы остаются действительными после перемещения и Swap и относятся
+// к вектору, которому перешёл буфер.
+// Нарушение печатается в stderr вместе с местом перевыделения, сделавшего итератор
+// недействительным, и завершает программу. Без макроса итераторы остаются указателями
+#if !defined(ADVANCED_VECTOR_HARDENED)
+#define ADVANCED_VECTOR_HARDENED 0
+#endif
+
+#if ADVANCED_VECTOR_HARDENED
+#include <cstdint>
+#include <cstdio>
+
+namespace detail {
+
+// Каждый выделенный буфер получает новое поколение, итераторы запоминают поколение своего буфера
+inline std::atomic<uint64_t> buffer_generation{0};
+
+inline uint64_t NextBufferGeneration() noexcept {
+    return buffer_generation.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+[[noreturn]] inline void HardenedFailure(const char* what, const char* site = nullptr) noexcept {
+    if (site != nullptr) {
+        std::fprintf(stderr, "advanced-vector: %s (buffer reallocated by %s)\n", what, site);
+    } else {
+        std::fprintf(stderr, "advanced-vector: %s\n", what);
+    }
+    std::abort();
+}
+
+}  // namespace detail
+#endif
+
+// Снимок счётчиков CountingStats
+struct VectorStats {
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t bytes_allocated = 0;
+    size_t bytes_deallocated = 0;
+    size_t peak_capacity_bytes = 0;
+    size_t reallocations[static_cast<size_t>(ReallocationSite::kCount)] = {};
+    // Элементы, перенесённые в новый буфер конструктором перемещения, копирования или побайтово
+    size_t elements_moved = 0;
+    size_t elements_copied = 0;
+    size_t elements_relocated = 0;
+
+    size_t Reallocations(ReallocationSite site) const noexcept {
+        return reallocations[static_cast<size_t>(site)];
+    }
+};
+
+// Политики инструментирования RawMemory и Vector. NoStats ничего не считает,
+// вызовы её пустых функций полностью удаляются компилятором
+struct NoStats {
+    static void OnAllocate(size_t /*bytes*/) noexcept {
+    }
+    static void OnDeallocate(size_t /*bytes*/) noexcept {
+    }
+    static void OnReallocation(ReallocationSite /*site*/) noexcept {
+    }
+    static void OnMove(size_t /*count*/) noexcept {
+    }
+    static void OnCopy(size_t /*count*/) noexcept {
+    }
+    static void OnRelocate(size_t /*count*/) noexcept {
+    }
+};
+
+// Считает события во всех векторах с этой политикой. Разные Tag дают независимые наборы счётчиков,
+// например для отдельных подсистем. Счётчики атомарные, Snapshot можно вызывать из любого потока
+template <typename Tag = void>
+class CountingStats {
+public:
+    static void OnAllocate(size_t bytes) noexcept {
+        Add(allocations_, 1);
+        Add(bytes_allocated_, bytes);
+        size_t peak = peak_capacity_bytes_.load(std::memory_order_relaxed);
+        while (bytes > peak
+               && !peak_capacity_bytes_.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {
+        }
+    }
+    static void OnDeallocate(size_t bytes) noexcept {
+        Add(deallocations_, 1);
+        Add(bytes_deallocated_, bytes);
+    }
+    static void OnReallocation(ReallocationSite site) noexcept {
+        Add(reallocations_[static_cast<size_t>(site)], 1);
+    }
+    static void OnMove(size_t count) noexcept {
+        Add(elements_moved_, count);
+    }
+    static void OnCopy(size_t count) noexcept {
+        Add(elements_copied_, count);
+    }
+    static void OnRelocate(size_t count) noexcept {
+        Add(elements_relocated_, count);
+    }
+
+    static VectorStats Snapshot() noexcept {
+        VectorStats stats;
+        stats.allocations = Load(allocations_);
+        stats.deallocations = Load(deallocations_);
+        stats.bytes_allocated = Load(bytes_allocated_);
+        stats.bytes_deallocated = Load(bytes_deallocated_);
+        stats.peak_capacity_bytes = Load(peak_capacity_bytes_);
+        for (size_t i = 0; i < static_cast<size_t>(ReallocationSite::kCount); ++i) {
+            stats.reallocations[i] = Load(reallocations_[i]);
+        }
+        stats.elements_moved = Load(elements_moved_);
+        stats.elements_copied = Load(elements_copied_);
+        stats.elements_relocated = Load(elements_relocated_);
+        return stats;
+    }
+
+    static void Reset() noexcept {
+        for (auto* counter : {&allocations_, &deallocations_, &bytes_allocated_, &bytes_deallocated_,
+                              &peak_capacity_bytes_, &elements_moved_, &elements_copied_,
+                              &elements_relocated_}) {
+            counter->store(0, std::memory_order_relaxed);
+        }
+        for (auto& counter : reallocations_) {
+            counter.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    static void Add(std::atomic<size_t>& counter, size_t value) noexcept {
+        counter.fetch_add(value, std::memory_order_relaxed);
+    }
+    static size_t Load(const std::atomic<size_t>& counter) noexcept {
+        return counter.load(std::memory_order_relaxed);
+    }
+
+    inline static std::atomic<size_t> allocations_{0};
+    inline static std::atomic<size_t> deallocations_{0};
+    inline static std::atomic<size_t> bytes_allocated_{0};
+    inline static std::atomic<size_t> bytes_deallocated_{0};
+    inline static std::atomic<size_t> peak_capacity_bytes_{0};
+    inline static std::atomic<size_t> reallocations_[static_cast<size_t>(ReallocationSite::kCount)] = {};
+    inline static std::atomic<size_t> elements_moved_{0};
+    inline static std::atomic<size_t> elements_copied_{0};
+    inline static std::atomic<size_t> elements_relocated_{0};
+};
+
+// Параллельное выполнение массовых операций над очень большими векторами: конструирования,
+// копирования, переноса и разрушения элементов. Исполнитель вызывает task(context, i) для каждого
+// i из [0, count), дожидается завершения всех задач и не выбрасывает исключений.
+// По умолчанию исполнителя нет и все операции выполняются в вызывающем потоке (см. parallel.h)
+using BulkTask = void (*)(void* context, size_t index);
+using BulkExecutor = void (*)(size_t count, BulkTask task, void* context) noexcept;
+
+struct BulkParallelism {
+    BulkExecutor executor = nullptr;
+    // Число частей, на которые делится операция
+    size_t concurrency = 1;
+    // Операции над меньшим объёмом памяти выполняются последовательно
+    size_t threshold_bytes = size_t{64} << 20;
+};
+
+namespace detail {
+
+inline constexpr size_t kMaxBulkChunks = 256;
+
+inline std::atomic<BulkExecutor> bulk_executor{nullptr};
+inline std::atomic<size_t> bulk_concurrency{1};
+inline std::atomic<size_t> bulk_threshold_bytes{BulkParallelism{}.threshold_bytes};
+
+}  // namespace detail
+
+// Настраивает параллельное выполнение массовых операций. Вызывается при старте программы,
+// пока векторы не используются из других потоков
+inline void SetBulkParallelism(const BulkParallelism& parallelism) noexcept {
+    detail::bulk_executor.store(parallelism.executor, std::memory_order_relaxed);
+    detail::bulk_concurrency.store(parallelism.concurrency, std::memory_order_relaxed);
+    detail::bulk_threshold_bytes.store(parallelism.threshold_bytes, std::memory_order_relaxed);
+}
+
+inline BulkParallelism GetBulkParallelism() noexcept {
+    return {detail::bulk_executor.load(std::memory_order_relaxed),
+            detail::bulk_concurrency.load(std::memory_order_relaxed),
+            detail::bulk_threshold_bytes.load(std::memory_order_relaxed)};
+}
+
+namespace detail {
+
+// Число частей для операции над n элементами размера element_size. 1 - выполнять последовательно
+inline size_t BulkChunkCount(size_t n, size_t element_size) noexcept {
+    const BulkParallelism parallelism = GetBulkParallelism();
+    if (parallelism.executor == nullptr || n < 2 || n * element_size < parallelism.threshold_bytes) {
+        return 1;
+    }
+    return std::min({parallelism.concurrency, kMaxBulkChunks, n});
+}
+
+// Границы части index при делении [0, n) на chunks почти равных частей
+inline std::pair<size_t, size_t> BulkChunkBounds(size_t n, size_t chunks, size_t index) noexcept {
+    const size_t base = n / chunks;
+    const size_t extra = n % chunks;
+    return {base * index + std::min(index, extra), base + (index < extra ? 1 : 0)};
+}
+
+template <typename F>
+struct BulkContext {
+    size_t n;
+    size_t chunks;
+    F* f;
+    std::exception_ptr* errors;
+};
+
+// Выполняет f(first, count) для части index. Исключение сохраняется в errors[index]
+template <typename F>
+void RunBulkChunk(void* context, size_t index) {
+    auto& ctx = *static_cast<BulkContext<F>*>(context);
+    const auto [first, count] = BulkChunkBounds(ctx.n, ctx.chunks, index);
+    try {
+        (*ctx.f)(first, count);
+    } catch (...) {
+        ctx.errors[index] = std::current_exception();
+    }
+}
+
+template <typename F>
+void RunBulkChunks(size_t n, size_t chunks, F& f, std::exception_ptr* errors) {
+    BulkContext<F> context{n, chunks, &f, errors};
+    bulk_executor.load(std::memory_order_relaxed)(chunks, &RunBulkChunk<F>, &context);
+}
+
+// Выполняет f(first, count) над частями диапазона [0, n), возможно параллельно.
+// Если часть выбросила исключение, оно пробрасывается после завершения всех частей
+template <typename F>
+void BulkFor(size_t n, size_t element_size, F f) {
+    const size_t chunks = BulkChunkCount(n, element_size);
+    if (chunks == 1) {
+        f(size_t{0}, n);
+        return;
+    }
+    std::exception_ptr errors[kMaxBulkChunks];
+    RunBulkChunks(n, chunks, f, errors);
+    for (size_t i = 0; i < chunks; ++i) {
+        if (errors[i]) {
+            std::rethrow_exception(errors[i]);
+        }
+    }
+}
+
+// Конструирует n элементов в сырой памяти dst. build(first, count) конструирует элементы
+// [first, first + count) и при исключении сам разрушает свои частично построенные элементы
+// (как std::uninitialized_*). Если не удалась хотя бы одна часть, уже построенные части
+// разрушаются, и в dst не остаётся живых объектов
+template <typename T, typename Build>
+void BulkConstruct(T* dst, size_t n, Build build) {
+    const size_t chunks = BulkChunkCount(n, sizeof(T));
+    if (chunks == 1) {
+        build(size_t{0}, n);
+        return;
+    }
+    std::exception_ptr errors[kMaxBulkChunks];
+    RunBulkChunks(n, chunks, build, errors);
+    const auto failed = std::find_if(errors, errors + chunks, [](const std::exception_ptr& error) {
+        return static_cast<bool>(error);
+    });
+    if (failed == errors + chunks) {
+        return;
+    }
+    for (size_t i = 0; i < chunks; ++i) {
+        if (!errors[i]) {
+            const auto [first, count] = BulkChunkBounds(n, chunks, i);
+            std::destroy_n(dst + first, count);
+        }
+    }
+    std::rethrow_exception(*failed);
+}
+
+// Разрушает n элементов, начиная с p, возможно параллельно
+template <typename T>
+void BulkDestroy(T* p, size_t n) noexcept {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        BulkFor(n, sizeof(T), [p](size_t first, size_t count) noexcept {
+            std::destroy_n(p + first, count);
+        });
+    }
+}
+
+}  // namespace detail
+
+// Сырая память под элементы типа T. Память выделяется и освобождается аллокатором Alloc,
+// сами элементы RawMemory не конструирует и не разрушает. Stats получает события выделения памяти
+template <typename T, typename Alloc = std::allocator<T>, typename Stats = NoStats>
+class RawMemory : private detail::AllocatorHolder<Alloc> {
+    using Holder = detail::AllocatorHolder<Alloc>;
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+    static_assert(std::is_same_v<typename AllocTraits::value_type, T>,
+                  "Alloc::value_type must be the same as T");
+
+public:
+    using allocator_type = Alloc;
+
     RawMemory() = default;
 
-    explicit RawMemory(size_t capacity)
-        : buffer_(Allocate(capacity))
+    explicit RawMemory(const Alloc& alloc) noexcept
+        : Holder(alloc) {
+    }
+
+    explicit RawMemory(size_t capacity, const Alloc& alloc = Alloc())
+        : Holder(alloc)
+        , buffer_(Allocate(capacity))
         , capacity_(capacity) {
+#if ADVANCED_VECTOR_HARDENED
+        generation_ = detail::NextBufferGeneration();
+#endif
     }
 
     ~RawMemory() {
-        Deallocate(buffer_);
+        Deallocate(buffer_, capacity_);
     }
 
     T* operator+(size_t offset) noexcept {
@@ -41,9 +541,40 @@ public:
         return buffer_[index];
     }
 
+    // Обменивает буферы вместе с аллокаторами: буфер всегда освобождается тем аллокатором,
+    // которым был выделен
     void Swap(RawMemory& other) noexcept {
+        using std::swap;
+        swap(GetAlloc(), other.GetAlloc());
         std::swap(buffer_, other.buffer_);
         std::swap(capacity_, other.capacity_);
+#if ADVANCED_VECTOR_HARDENED
+        std::swap(generation_, other.generation_);
+#endif
+    }
+
+    const Alloc& GetAllocator() const noexcept {
+        return GetAlloc();
+    }
+
+    // Изменяет вместимость с сохранением содержимого буфера средствами аллокатора (reallocate).
+    // Подходит только для тривиально переносимых элементов
+    void Reallocate(size_t new_capacity) {
+        static_assert(detail::HasReallocate<Alloc>::value, "Alloc does not provide reallocate");
+        if (new_capacity == 0) {
+            Deallocate(buffer_, capacity_);
+            buffer_ = nullptr;
+        } else if (buffer_ == nullptr) {
+            buffer_ = Allocate(new_capacity);
+        } else {
+            buffer_ = GetAlloc().reallocate(buffer_, capacity_, new_capacity);
+            Stats::OnDeallocate(capacity_ * sizeof(T));
+            Stats::OnAllocate(new_capacity * sizeof(T));
+        }
+        capacity_ = new_capacity;
+#if ADVANCED_VECTOR_HARDENED
+        generation_ = detail::NextBufferGeneration();
+#endif
     }
 
     const T* GetAddress() const noexcept {
@@ -57,11 +588,23 @@ public:
     size_t Capacity() const {
         return capacity_;
     }
+
+#if ADVANCED_VECTOR_HARDENED
+    // Поколение буфера меняется при каждом выделении и перевыделении
+    uint64_t Generation() const noexcept {
+        return generation_;
+    }
+#endif
     
     RawMemory(const RawMemory&) = delete;
     RawMemory& operator=(const RawMemory& rhs) = delete;
-    RawMemory(RawMemory&& other) noexcept {
-        Swap(other);
+    RawMemory(RawMemory&& other) noexcept
+        : Holder(std::move(other.GetAlloc())) {
+        std::swap(buffer_, other.buffer_);
+        std::swap(capacity_, other.capacity_);
+#if ADVANCED_VECTOR_HARDENED
+        std::swap(generation_, other.generation_);
+#endif
     }
     RawMemory& operator=(RawMemory&& rhs) noexcept {
         if (this != &rhs) {
@@ -71,67 +614,412 @@ public:
     }
 
 private:
+    using Holder::GetAlloc;
+
     // Выделяет сырую память под n элементов и возвращает указатель на неё
-    static T* Allocate(size_t n) {
-        return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+    T* Allocate(size_t n) {
+        if (n == 0) {
+            return nullptr;
+        }
+        T* buf = AllocTraits::allocate(GetAlloc(), n);
+        Stats::OnAllocate(n * sizeof(T));
+        return buf;
     }
 
-    // Освобождает сырую память, выделенную ранее по адресу buf при помощи Allocate
-    static void Deallocate(T* buf) noexcept {
-        operator delete(buf);
+    // Освобождает сырую память под n элементов, выделенную ранее по адресу buf при помощи Allocate
+    void Deallocate(T* buf, size_t n) noexcept {
+        if (buf != nullptr) {
+            AllocTraits::deallocate(GetAlloc(), buf, n);
+            Stats::OnDeallocate(n * sizeof(T));
+        }
     }
 
     T* buffer_ = nullptr;
     size_t capacity_ = 0;
+#if ADVANCED_VECTOR_HARDENED
+    uint64_t generation_ = 0;
+#endif
 };
 
-template <typename T>
+// Тег конструирования элементов инициализацией по умолчанию: память под тривиальные типы
+// остаётся неинициализированной и не заполняется нулями
+struct DefaultInitT {
+    explicit DefaultInitT() = default;
+};
+
+inline constexpr DefaultInitT kDefaultInit{};
+
+// Стратегии роста вместимости. NextCapacity(capacity, required, element_size) возвращает
+// новую вместимость буфера, которая не меньше required
+
+// Геометрический рост в Numerator / Denominator раз. MinCapacity - вместимость первого буфера
+template <size_t Numerator, size_t Denominator, size_t MinCapacity = 1>
+struct GeometricGrowth {
+    static_assert(Numerator > Denominator && Denominator > 0, "growth factor must be greater than 1");
+
+    static size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        constexpr size_t kMax = std::numeric_limits<size_t>::max();
+        const size_t grown = capacity > kMax / Numerator ? kMax : capacity * Numerator / Denominator;
+        return std::max({grown, required, MinCapacity});
+    }
+};
+
+using DoublingGrowth = GeometricGrowth<2, 1>;
+using OneAndHalfGrowth = GeometricGrowth<3, 2>;
+
+// Линейный рост на ChunkSize элементов: вместимость всегда кратна ChunkSize
+template <size_t ChunkSize>
+struct FixedChunkGrowth {
+    static_assert(ChunkSize > 0, "chunk size must be positive");
+
+    static size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        const size_t target = std::max(capacity + ChunkSize, required);
+        return (target + ChunkSize - 1) / ChunkSize * ChunkSize;
+    }
+};
+
+// Округляет вместимость, выбранную стратегией Base, до размера блока, который аллокатор
+// всё равно выделит: до степени двойки для блоков меньше страницы и до целого числа страниц для крупных
+template <typename Base = DoublingGrowth, size_t PageSize = 4096>
+struct SizeClassGrowth {
+    static_assert((PageSize & (PageSize - 1)) == 0, "page size must be a power of two");
+
+    static size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        const size_t target = Base::NextCapacity(capacity, required, element_size);
+        if (target > (std::numeric_limits<size_t>::max() - PageSize) / element_size) {
+            return target;
+        }
+        const size_t bytes = target * element_size;
+        size_t rounded = PageSize;
+        if (bytes < PageSize) {
+            for (rounded = 16; rounded < bytes; rounded *= 2) {
+            }
+        } else {
+            rounded = (bytes + PageSize - 1) / PageSize * PageSize;
+        }
+        return std::max(target, rounded / element_size);
+    }
+};
+
+// Стратегии автоматического освобождения памяти при уменьшении размера вектора.
+// ShrinkCapacity(size, capacity) возвращает новую вместимость или capacity, если сжимать буфер не нужно
+
+struct NoShrink {
+    static constexpr bool kEnabled = false;
+
+    static size_t ShrinkCapacity(size_t /*size*/, size_t capacity) noexcept {
+        return capacity;
+    }
+};
+
+// Сжимает буфер, когда размер становится меньше capacity / Divisor. Новая вместимость
+// в Headroom раз больше размера, чтобы чередование вставок и удалений не вызывало постоянных перевыделений
+template <size_t Divisor = 4, size_t Headroom = 2>
+struct HysteresisShrink {
+    static_assert(Divisor > Headroom && Headroom > 0, "shrink threshold must leave headroom");
+
+    static constexpr bool kEnabled = true;
+
+    static size_t ShrinkCapacity(size_t size, size_t capacity) noexcept {
+        return size < capacity / Divisor ? size * Headroom : capacity;
+    }
+};
+
+#if ADVANCED_VECTOR_HARDENED
+namespace detail {
+
+// Вектор, которому сейчас принадлежит буфер. Общий для вектора и его итераторов: при перемещении
+// и обмене переходит к новому владельцу вместе с буфером, при разрушении вектора обнуляется
+template <typename Owner>
+struct IteratorOwner {
+    const Owner* vector = nullptr;
+};
+
+// Итератор защищённого режима: указатель вместе с владельцем буфера и поколением буфера
+// на момент получения итератора. Разыменование и арифметика проверяются владельцем.
+// Итераторы, полученные конструктором по умолчанию, сравниваются только между собой
+template <typename Owner, typename T>
+class CheckedIterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::remove_const_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    CheckedIterator() = default;
+
+    CheckedIterator(T* ptr, std::shared_ptr<IteratorOwner<Owner>> owner, uint64_t generation) noexcept
+        : ptr_(ptr)
+        , owner_(std::move(owner))
+        , generation_(generation) {
+    }
+
+    // iterator неявно приводится к const_iterator
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T> && !std::is_same_v<U, T>>>
+    CheckedIterator(const CheckedIterator<Owner, U>& other) noexcept
+        : ptr_(other.ptr_)
+        , owner_(other.owner_)
+        , generation_(other.generation_) {
+    }
+
+    // Проверенный указатель. dereferenceable - итератор должен указывать на элемент, а не на end()
+    T* Get(bool dereferenceable) const noexcept {
+        if (owner_ == nullptr) {
+            HardenedFailure("use of a singular iterator");
+        }
+        if (owner_->vector == nullptr) {
+            HardenedFailure("use of an iterator of a destroyed Vector");
+        }
+        owner_->vector->CheckIterator(ptr_, generation_, dereferenceable);
+        return ptr_;
+    }
+
+    const Owner* GetOwner() const noexcept {
+        return owner_ != nullptr ? owner_->vector : nullptr;
+    }
+
+    T& operator*() const noexcept {
+        return *Get(true);
+    }
+    T* operator->() const noexcept {
+        return Get(true);
+    }
+    T& operator[](difference_type n) const noexcept {
+        return *(*this + n);
+    }
+
+    CheckedIterator& operator+=(difference_type n) noexcept {
+        ptr_ = Get(false) + n;
+        Get(false);
+        return *this;
+    }
+    CheckedIterator& operator-=(difference_type n) noexcept {
+        return *this += -n;
+    }
+    CheckedIterator& operator++() noexcept {
+        return *this += 1;
+    }
+    CheckedIterator& operator--() noexcept {
+        return *this += -1;
+    }
+    CheckedIterator operator++(int) noexcept {
+        CheckedIterator old = *this;
+        ++*this;
+        return old;
+    }
+    CheckedIterator operator--(int) noexcept {
+        CheckedIterator old = *this;
+        --*this;
+        return old;
+    }
+
+    friend CheckedIterator operator+(CheckedIterator it, difference_type n) noexcept {
+        return it += n;
+    }
+    friend CheckedIterator operator+(difference_type n, CheckedIterator it) noexcept {
+        return it += n;
+    }
+    friend CheckedIterator operator-(CheckedIterator it, difference_type n) noexcept {
+        return it -= n;
+    }
+
+    // Разность и сравнение определены только для итераторов одного вектора
+    template <typename U>
+    difference_type operator-(const CheckedIterator<Owner, U>& other) const noexcept {
+        CheckSameOwner(other);
+        return ptr_ - other.ptr_;
+    }
+    template <typename U>
+    bool operator==(const CheckedIterator<Owner, U>& other) const noexcept {
+        CheckSameOwner(other);
+        return ptr_ == other.ptr_;
+    }
+    template <typename U>
+    bool operator!=(const CheckedIterator<Owner, U>& other) const noexcept {
+        return !(*this == other);
+    }
+    template <typename U>
+    bool operator<(const CheckedIterator<Owner, U>& other) const noexcept {
+        CheckSameOwner(other);
+        return ptr_ < other.ptr_;
+    }
+    template <typename U>
+    bool operator>(const CheckedIterator<Owner, U>& other) const noexcept {
+        return other < *this;
+    }
+    template <typename U>
+    bool operator<=(const CheckedIterator<Owner, U>& other) const noexcept {
+        return !(other < *this);
+    }
+    template <typename U>
+    bool operator>=(const CheckedIterator<Owner, U>& other) const noexcept {
+        return !(*this < other);
+    }
+
+private:
+    template <typename, typename>
+    friend class CheckedIterator;
+
+    template <typename U>
+    void CheckSameOwner(const CheckedIterator<Owner, U>& other) const noexcept {
+        if (owner_ != other.owner_) {
+            HardenedFailure("iterators of different vectors are compared");
+        }
+        if (owner_ != nullptr) {
+            Get(false);
+            other.Get(false);
+        }
+    }
+
+    T* ptr_ = nullptr;
+    std::shared_ptr<IteratorOwner<Owner>> owner_;
+    uint64_t generation_ = 0;
+};
+
+}  // namespace detail
+#endif
+
+// Аллокатор отвечает только за выделение памяти: элементы конструируются и разрушаются
+// на месте, как и при std::allocator. Growth задаёт стратегию роста вместимости,
+// Shrink - автоматического сжатия буфера при удалении элементов, Stats - политика инструментирования
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth,
+          typename Shrink = NoShrink, typename Stats = NoStats>
 class Vector {
-public:    
+    using AllocTraits = std::allocator_traits<Alloc>;
+    using Memory = RawMemory<T, Alloc, Stats>;
+
+    // Элементы переносятся при помощи memcpy/memmove
+    static constexpr bool kRelocateBytes = kIsTriviallyRelocatable<T>;
+    // Буфер растёт на месте через Alloc::reallocate
+    static constexpr bool kReallocateInPlace = kRelocateBytes && detail::HasReallocate<Alloc>::value;
+
+public:
+    using value_type = T;
+    using allocator_type = Alloc;
+#if ADVANCED_VECTOR_HARDENED
+    using iterator = detail::CheckedIterator<Vector, T>;
+    using const_iterator = detail::CheckedIterator<Vector, const T>;
+#else
     using iterator = T*;
     using const_iterator = const T*;
+#endif
     
     iterator begin() noexcept {
-        return data_.GetAddress();
+        return MakeIterator(data_.GetAddress());
     }
     iterator end() noexcept {
-        return data_.GetAddress() + size_;
+        return MakeIterator(data_.GetAddress() + size_);
     }
     const_iterator begin() const noexcept {
-        return data_.GetAddress();
+        return MakeIterator(data_.GetAddress());
     }
     const_iterator end() const noexcept {
-        return data_.GetAddress() + size_;
+        return MakeIterator(data_.GetAddress() + size_);
     }
     const_iterator cbegin() const noexcept {
-        return data_.GetAddress();
+        return begin();
     }
     const_iterator cend() const noexcept {
-        return data_.GetAddress() + size_;
+        return end();
+    }
+
+    T* Data() noexcept {
+        return data_.GetAddress();
     }
+    const T* Data() const noexcept {
+        return data_.GetAddress();
+    }
+
+#if defined(__cpp_lib_span)
+    operator std::span<T>() noexcept {
+        return {Data(), size_};
+    }
+    operator std::span<const T>() const noexcept {
+        return {Data(), size_};
+    }
+#endif
     
     Vector() = default;
 
-    explicit Vector(size_t size)
-        : data_(size)
+    explicit Vector(const Alloc& alloc) noexcept
+        : data_(alloc) {
+    }
+
+    explicit Vector(size_t size, const Alloc& alloc = Alloc())
+        : data_(size, alloc)
+        , size_(size)  //
+    {
+        T* dst = data_.GetAddress();
+        detail::BulkConstruct(dst, size, [dst](size_t first, size_t count) {
+            std::uninitialized_value_construct_n(dst + first, count);
+        });
+    }
+
+    Vector(size_t size, DefaultInitT, const Alloc& alloc = Alloc())
+        : data_(size, alloc)
         , size_(size)  //
     {
-        std::uninitialized_value_construct_n(data_.GetAddress(), size);
+        if constexpr (!std::is_trivially_default_constructible_v<T>) {
+            T* dst = data_.GetAddress();
+            detail::BulkConstruct(dst, size, [dst](size_t first, size_t count) {
+                std::uninitialized_default_construct_n(dst + first, count);
+            });
+        }
+    }
+    
+    Vector(size_t size, const T& value, const Alloc& alloc = Alloc())
+        : data_(size, alloc)
+        , size_(size)  //
+    {
+        T* dst = data_.GetAddress();
+        detail::BulkConstruct(dst, size, [dst, &value](size_t first, size_t count) {
+            std::uninitialized_fill_n(dst + first, count, value);
+        });
+    }
+
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    Vector(InputIt first, InputIt last, const Alloc& alloc = Alloc())
+        : data_(alloc) {
+        try {
+            Append(first, last);
+        } catch (...) {
+            std::destroy_n(data_.GetAddress(), size_);
+            throw;
+        }
     }
     
     Vector(const Vector& other)
-        : data_(other.size_)
+        : Vector(other, AllocTraits::select_on_container_copy_construction(other.GetAllocator())) {
+    }
+
+    Vector(const Vector& other, const Alloc& alloc)
+        : data_(other.size_, alloc)
         , size_(other.size_)  //
     {
-        std::uninitialized_copy_n(other.data_.GetAddress(), size_, data_.GetAddress());
+        const T* src = other.data_.GetAddress();
+        T* dst = data_.GetAddress();
+        detail::BulkConstruct(dst, size_, [src, dst](size_t first, size_t count) {
+            std::uninitialized_copy_n(src + first, count, dst + first);
+        });
     }
     
-    Vector(Vector&& other) {
-        Swap(other);
+    Vector(Vector&& other) noexcept
+        : data_(std::move(other.data_))
+        , size_(std::exchange(other.size_, 0)) {
+#if ADVANCED_VECTOR_HARDENED
+        reallocated_by_ = other.reallocated_by_;
+        SwapIteratorOwners(other);
+#endif
     }
     
     ~Vector() {
-        std::destroy_n(data_.GetAddress(), size_);
+#if ADVANCED_VECTOR_HARDENED
+        if (iterator_owner_ != nullptr) {
+            iterator_owner_->vector = nullptr;
+        }
+#endif
+        detail::BulkDestroy(data_.GetAddress(), size_);
     }
     
     size_t Size() const noexcept {
@@ -142,11 +1030,20 @@ public:
         return data_.Capacity();
     }
 
+    const Alloc& GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
     const T& operator[](size_t index) const noexcept {
         return const_cast<Vector&>(*this)[index];
     }
 
     T& operator[](size_t index) noexcept {
+#if ADVANCED_VECTOR_HARDENED
+        if (index >= size_) {
+            detail::HardenedFailure("Vector index out of range");
+        }
+#endif
         assert(index < size_);
         return data_[index];
     }
@@ -155,20 +1052,78 @@ public:
         if (new_capacity <= data_.Capacity()) {
             return;
         }
-        RawMemory<T> new_data(new_capacity);
-        SwapCopy(new_data);
+        Reallocate(new_capacity, ReallocationSite::kReserve);
     }
     
+    // Растёт по стратегии Growth, поэтому цикл Resize(Size() + k) выполняет O(log n) перевыделений
     void Resize(size_t new_size) {
         if (new_size < size_) {
             std::destroy_n(data_.GetAddress() + new_size, size_ - new_size);
+            size_ = new_size;
+            MaybeShrink();
         } else {
-            Reserve(new_size);
-            std::uninitialized_value_construct_n(data_.GetAddress() + new_size, new_size - size_);            
+            Grow(new_size);
+            std::uninitialized_value_construct_n(data_.GetAddress() + size_, new_size - size_);
+            size_ = new_size;
         }
-        size_ = new_size;
     }
-    
+
+    // Как Resize, но новые элементы инициализируются по умолчанию (тривиальные типы - не инициализируются)
+    void ResizeDefaultInit(size_t new_size) {
+        if (new_size < size_) {
+            std::destroy_n(data_.GetAddress() + new_size, size_ - new_size);
+            size_ = new_size;
+            MaybeShrink();
+        } else {
+            Grow(new_size);
+            std::uninitialized_default_construct_n(data_.GetAddress() + size_, new_size - size_);
+            size_ = new_size;
+        }
+    }
+
+    // Аналог basic_string::resize_and_overwrite. Вектор расширяется до new_size элементов, новые
+    // инициализируются по умолчанию, затем op(Data, new_size) заполняет буфер и возвращает итоговый
+    // размер, не превышающий new_size. Элементы за итоговым размером разрушаются
+    template <typename Operation>
+    void ResizeAndOverwrite(size_t new_size, Operation op) {
+        const size_t old_size = std::min(size_, new_size);
+        ResizeDefaultInit(new_size);
+        size_t result_size = 0;
+        try {
+            result_size = std::move(op)(data_.GetAddress(), new_size);
+        } catch (...) {
+            std::destroy_n(data_.GetAddress() + old_size, size_ - old_size);
+            size_ = old_size;
+            throw;
+        }
+        assert(result_size <= new_size);
+        std::destroy_n(data_.GetAddress() + result_size, size_ - result_size);
+        size_ = result_size;
+    }
+
+    // Дозапись в свободный хвост буфера: вместимость растёт по стратегии роста, op(Data() + Size(), max_count)
+    // заполняет до max_count новых элементов и возвращает их число. Серия дозаписей перевыделяет
+    // память амортизированно O(1) раз. Возвращает число добавленных элементов
+    template <typename Operation>
+    size_t AppendAndOverwrite(size_t max_count, Operation op) {
+        const size_t old_size = size_;
+        Grow(size_ + max_count);
+        std::uninitialized_default_construct_n(data_.GetAddress() + size_, max_count);
+        size_ += max_count;
+        size_t appended = 0;
+        try {
+            appended = std::move(op)(data_.GetAddress() + old_size, max_count);
+        } catch (...) {
+            std::destroy_n(data_.GetAddress() + old_size, max_count);
+            size_ = old_size;
+            throw;
+        }
+        assert(appended <= max_count);
+        std::destroy_n(data_.GetAddress() + old_size + appended, max_count - appended);
+        size_ = old_size + appended;
+        return appended;
+    }
+
     void PushBack(const T& value) {
         EmplaceBack(value);
     }
@@ -180,9 +1135,21 @@ public:
     template <typename... Args>
     T& EmplaceBack(Args&&... args) {
         if (size_ == Capacity()) {
-            RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
-            new (new_data + size_) T(std::forward<Args>(args)...);
-            SwapCopy(new_data);
+            if constexpr (kReallocateInPlace) {
+                detail::RelocationSlot<T> slot(std::forward<Args>(args)...);
+                Reallocate(NextCapacity(size_ + 1), ReallocationSite::kEmplaceBack);
+                slot.RelocateTo(data_ + size_);
+            } else {
+                Memory new_data(NextCapacity(size_ + 1), GetAllocator());
+                new (new_data + size_) T(std::forward<Args>(args)...);
+                OnReallocation(ReallocationSite::kEmplaceBack);
+                try {
+                    SwapCopy(new_data);
+                } catch (...) {
+                    std::destroy_at(new_data + size_);
+                    throw;
+                }
+            }
         } else {
             new (data_ + size_) T(std::forward<Args>(args)...);
         }
@@ -190,12 +1157,42 @@ public:
         return data_[size_ - 1];
     }
     
+    // Добавляет элементы [first, last) в конец. Для однонаправленных итераторов
+    // выполняется не более одного перевыделения памяти
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    void Append(InputIt first, InputIt last) {
+        if constexpr (detail::IsForwardIterator<InputIt>::value) {
+            const size_t count = std::distance(first, last);
+            Grow(size_ + count);
+            std::uninitialized_copy(first, last, data_ + size_);
+            size_ += count;
+        } else {
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+        }
+    }
+    
     void PopBack() {
         if (size_ == 0) {
             return;
         }
         std::destroy_at(data_.GetAddress() + size_ - 1);
         --size_;
+        MaybeShrink();
+    }
+
+    void Clear() noexcept {
+        std::destroy_n(data_.GetAddress(), size_);
+        size_ = 0;
+        MaybeShrink();
+    }
+
+    // Уменьшает вместимость до размера, перенося элементы так же, как при росте
+    void ShrinkToFit() {
+        if (Capacity() > size_) {
+            Reallocate(size_, ReallocationSite::kShrink);
+        }
     }
     
     iterator Insert(const_iterator pos, const T& value) {
@@ -206,31 +1203,91 @@ public:
         return Emplace(pos, std::move(value));
     }
     
+    // Вставляет элементы [first, last) перед pos. Для однонаправленных итераторов память
+    // перевыделяется не более одного раза, а хвост сдвигается однократно
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+        CheckPosition(pos, false);
+        assert(pos >= begin() && pos <= end());
+        const size_t idx = pos - begin();
+        if constexpr (detail::IsForwardIterator<InputIt>::value) {
+            InsertN(
+                idx, std::distance(first, last),
+                [first](T* dst, size_t from, size_t count) {
+                    std::uninitialized_copy_n(std::next(first, from), count, dst);
+                },
+                [first](T* dst, size_t from, size_t count) {
+                    std::copy_n(std::next(first, from), count, dst);
+                });
+        } else {
+            const size_t old_size = size_;
+            Append(first, last);
+            std::rotate(begin() + idx, begin() + old_size, end());
+        }
+        return begin() + idx;
+    }
+
+    // Вставляет count копий value перед pos
+    iterator Insert(const_iterator pos, size_t count, const T& value) {
+        CheckPosition(pos, false);
+        assert(pos >= begin() && pos <= end());
+        const size_t idx = pos - begin();
+        if (count != 0) {
+            // value может ссылаться на элемент самого вектора
+            const T copy(value);
+            InsertN(
+                idx, count,
+                [&copy](T* dst, size_t /*from*/, size_t n) {
+                    std::uninitialized_fill_n(dst, n, copy);
+                },
+                [&copy](T* dst, size_t /*from*/, size_t n) {
+                    std::fill_n(dst, n, copy);
+                });
+        }
+        return begin() + idx;
+    }
+    
     template <typename... Args>
     iterator Emplace(const_iterator pos, Args&&... args) {
+        CheckPosition(pos, false);
         if (pos >= begin() && pos <= end()) {
             size_t idx = pos - begin();
+            if constexpr (kReallocateInPlace) {
+                if (size_ == data_.Capacity()) {
+                    detail::RelocationSlot<T> slot(std::forward<Args>(args)...);
+                    Reallocate(NextCapacity(size_ + 1), ReallocationSite::kEmplace);
+                    detail::RelocateBytesOverlapping(data_ + idx, size_ - idx, data_ + idx + 1);
+                    slot.RelocateTo(data_ + idx);
+                    ++size_;
+                    return begin() + idx;
+                }
+            }
             if (size_ == data_.Capacity()) {
-                RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
+                Memory new_data(NextCapacity(size_ + 1), GetAllocator());
                 new (new_data + idx) T(std::forward<Args>(args)...);
-                try {
-                    CopyTo(new_data, 0, idx, 0);
-                } catch (...) {
-                    std::destroy_at(new_data + idx);
-                    throw;
-                }
-                try {
-                    CopyTo(new_data, idx, size_, idx + 1);
-                } catch (...) {
-                    std::destroy_n(new_data.GetAddress(), idx + 1);
-                    throw;
+                OnReallocation(ReallocationSite::kEmplace);
+                if constexpr (kRelocateBytes) {
+                    RelocateTo(new_data, 0, idx, 0);
+                    RelocateTo(new_data, idx, size_, idx + 1);
+                } else {
+                    try {
+                        CopyTo(new_data, 0, idx, 0);
+                    } catch (...) {
+                        std::destroy_at(new_data + idx);
+                        throw;
+                    }
+                    try {
+                        CopyTo(new_data, idx, size_, idx + 1);
+                    } catch (...) {
+                        std::destroy_n(new_data.GetAddress(), idx + 1);
+                        throw;
+                    }
+                    std::destroy_n(data_.GetAddress(), size_);
                 }
-                std::destroy_n(data_.GetAddress(), size_);
                 data_.Swap(new_data);
             } else {
-                T tmp(std::forward<Args>(args)...);
-                std::move_backward(begin() + idx, end(), end() + 1);
-                new (data_ + idx) T(std::move(tmp));
+                EmplaceInPlace(idx, std::forward<Args>(args)...);
+                return begin() + idx;
             }
             ++size_;
             return begin() + idx;
@@ -239,21 +1296,172 @@ public:
     }
     
     iterator Erase(const_iterator pos) {
-        if (pos >= begin() && pos <= end()) {
+        CheckPosition(pos, true);
+        if (pos >= begin() && pos < end()) {
             size_t idx = pos - begin();
-            std::destroy_at(data_ + idx);
-            std::move(begin() + idx + 1, end(), begin() + idx);
+            if constexpr (kRelocateBytes) {
+                std::destroy_at(data_ + idx);
+                detail::RelocateBytesOverlapping(data_ + idx + 1, size_ - idx - 1, data_ + idx);
+            } else {
+                std::move(begin() + idx + 1, end(), begin() + idx);
+                std::destroy_at(data_ + size_ - 1);
+            }
             --size_;
+            MaybeShrink();
             return begin() + idx;
         }
         return end();
     }
+
+    // Удаляет элементы [first, last): хвост сдвигается один раз
+    iterator Erase(const_iterator first, const_iterator last) {
+        CheckPosition(first, false);
+        CheckPosition(last, false);
+        assert(first >= begin() && first <= last && last <= end());
+        const size_t idx = first - begin();
+        const size_t count = last - first;
+        if (count != 0) {
+            if constexpr (kRelocateBytes) {
+                std::destroy_n(data_ + idx, count);
+                detail::RelocateBytesOverlapping(data_ + idx + count, size_ - idx - count, data_ + idx);
+            } else {
+                std::move(begin() + idx + count, end(), begin() + idx);
+                std::destroy_n(data_ + (size_ - count), count);
+            }
+            size_ -= count;
+            MaybeShrink();
+        }
+        return begin() + idx;
+    }
+
+    // Удаляет элемент за O(1), ставя на его место последний. Порядок элементов не сохраняется
+    iterator SwapRemove(const_iterator pos) {
+        CheckPosition(pos, true);
+        assert(pos >= begin() && pos < end());
+        const size_t idx = pos - begin();
+        T* target = data_ + idx;
+        T* last = data_ + size_ - 1;
+        if constexpr (kRelocateBytes) {
+            std::destroy_at(target);
+            if (target != last) {
+                detail::RelocateBytes(last, 1, target);
+            }
+        } else {
+            if (target != last) {
+                *target = std::move(*last);
+            }
+            std::destroy_at(last);
+        }
+        --size_;
+        MaybeShrink();
+        return begin() + idx;
+    }
+
+    // Удаляет за один проход элементы, для которых pred истинен, сохраняя порядок остальных.
+    // Возвращает количество удалённых элементов
+    template <typename Predicate>
+    size_t Compact(Predicate pred) {
+        T* first = data_.GetAddress();
+        T* last = first + size_;
+        if constexpr (kRelocateBytes) {
+            T* write = first;
+            T* read = first;
+            try {
+                for (; read != last; ++read) {
+                    if (pred(*read)) {
+                        std::destroy_at(read);
+                    } else {
+                        if (write != read) {
+                            detail::RelocateBytes(read, 1, write);
+                        }
+                        ++write;
+                    }
+                }
+            } catch (...) {
+                // Непросмотренные элементы сдвигаются к сохранённым, чтобы не осталось дыры
+                detail::RelocateBytesOverlapping(read, last - read, write);
+                size_ = (write - first) + (last - read);
+                throw;
+            }
+            const size_t removed = last - write;
+            size_ -= removed;
+            MaybeShrink();
+            return removed;
+        } else {
+            T* new_end = std::remove_if(first, last, pred);
+            const size_t removed = last - new_end;
+            std::destroy_n(new_end, removed);
+            size_ -= removed;
+            MaybeShrink();
+            return removed;
+        }
+    }
+    
+    // Заменяет содержимое элементами [first, last)
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    void Assign(InputIt first, InputIt last) {
+        if constexpr (detail::IsForwardIterator<InputIt>::value) {
+            const size_t count = std::distance(first, last);
+            if (count > Capacity()) {
+                // Буфер заполняется напрямую: временный вектор учёл бы ещё одно перевыделение в Append
+                Memory new_data(count, GetAllocator());
+                std::uninitialized_copy(first, last, new_data.GetAddress());
+                OnReallocation(ReallocationSite::kAssignment);
+                std::destroy_n(data_.GetAddress(), size_);
+                data_.Swap(new_data);
+                size_ = count;
+                return;
+            }
+            const size_t cp_size = std::min(size_, count);
+            const InputIt mid = std::next(first, cp_size);
+            std::copy(first, mid, data_.GetAddress());
+            if (count < size_) {
+                std::destroy_n(data_ + count, size_ - count);
+            } else {
+                std::uninitialized_copy(mid, last, data_ + size_);
+            }
+            size_ = count;
+        } else {
+            std::destroy_n(data_.GetAddress(), size_);
+            size_ = 0;
+            Append(first, last);
+        }
+    }
+
+    // Заменяет содержимое count копиями value
+    void Assign(size_t count, const T& value) {
+        if (count > Capacity()) {
+            Memory new_data(count, GetAllocator());
+            std::uninitialized_fill_n(new_data.GetAddress(), count, value);
+            OnReallocation(ReallocationSite::kAssignment);
+            std::destroy_n(data_.GetAddress(), size_);
+            data_.Swap(new_data);
+        } else {
+            std::fill_n(data_.GetAddress(), std::min(size_, count), value);
+            if (count < size_) {
+                std::destroy_n(data_ + count, size_ - count);
+            } else {
+                std::uninitialized_fill_n(data_ + size_, count - size_, value);
+            }
+        }
+        size_ = count;
+    }
     
     Vector& operator=(const Vector& rhs) {
         if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                if (GetAllocator() != rhs.GetAllocator()) {
+                    // Текущий буфер нельзя использовать с аллокатором rhs, поэтому копия строится заново
+                    Vector rhs_copy(rhs, rhs.GetAllocator());
+                    SwapStorage(rhs_copy);
+                    OnReallocation(ReallocationSite::kAssignment);
+                    return *this;
+                }
+            }
             if (rhs.size_ > data_.Capacity()) {
-                Vector rhs_copy(rhs);
-                Swap(rhs_copy);
+                Vector rhs_copy(rhs, GetAllocator());
+                SwapStorage(rhs_copy);
+                OnReallocation(ReallocationSite::kAssignment);
             } else {
                 CopyFrom(rhs);
             }
@@ -261,42 +1469,360 @@ public:
         return *this;
     }
     
-    Vector& operator=(Vector&& rhs) {
+    // Не выбрасывает исключений, если буфер rhs можно забрать: аллокатор распространяется
+    // при перемещении или все его экземпляры равны
+    Vector& operator=(Vector&& rhs) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                             || AllocTraits::is_always_equal::value) {
         if (this != &rhs) {
-            Swap(rhs);
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value
+                          || AllocTraits::is_always_equal::value) {
+                SwapStorage(rhs);
+                SwapIteratorOwners(rhs);
+            } else if (GetAllocator() == rhs.GetAllocator()) {
+                SwapStorage(rhs);
+                SwapIteratorOwners(rhs);
+            } else {
+                // Буфер rhs принадлежит чужому аллокатору, поэтому элементы перемещаются в свою память
+                Memory new_data(rhs.size_, GetAllocator());
+                std::uninitialized_move_n(rhs.data_.GetAddress(), rhs.size_, new_data.GetAddress());
+                OnReallocation(ReallocationSite::kAssignment);
+                Stats::OnMove(rhs.size_);
+                std::destroy_n(data_.GetAddress(), size_);
+                data_.Swap(new_data);
+                size_ = rhs.size_;
+            }
         }
         return *this;
     }
     
+    // Аллокаторы, которые не распространяются при обмене, обязаны быть равны
     void Swap(Vector& other) noexcept {
+        if constexpr (!AllocTraits::propagate_on_container_swap::value) {
+            assert(GetAllocator() == other.GetAllocator());
+        }
+        SwapStorage(other);
+        SwapIteratorOwners(other);
+    }
+
+private:
+#if ADVANCED_VECTOR_HARDENED
+    template <typename, typename>
+    friend class detail::CheckedIterator;
+
+    iterator MakeIterator(T* ptr) noexcept {
+        return iterator(ptr, GetIteratorOwner(), data_.Generation());
+    }
+    const_iterator MakeIterator(const T* ptr) const noexcept {
+        return const_iterator(ptr, GetIteratorOwner(), data_.Generation());
+    }
+
+    // Создаётся при получении первого итератора. Нехватка памяти здесь завершает программу
+    const std::shared_ptr<detail::IteratorOwner<Vector>>& GetIteratorOwner() const noexcept {
+        if (iterator_owner_ == nullptr) {
+            iterator_owner_ = std::make_shared<detail::IteratorOwner<Vector>>();
+            iterator_owner_->vector = this;
+        }
+        return iterator_owner_;
+    }
+
+    // Итераторы следуют за буфером: после перемещения и Swap они проверяются новым владельцем.
+    // Временные векторы Assign и копирующего присваивания владельцами не обмениваются, поэтому
+    // итераторы заменённого буфера считаются устаревшими по поколению
+    void SwapIteratorOwners(Vector& other) noexcept {
+        std::swap(iterator_owner_, other.iterator_owner_);
+        if (iterator_owner_ != nullptr) {
+            iterator_owner_->vector = this;
+        }
+        if (other.iterator_owner_ != nullptr) {
+            other.iterator_owner_->vector = &other;
+        }
+    }
+
+    // Итератор получен после последнего перевыделения буфера и указывает внутрь [begin, end]
+    void CheckIterator(const T* ptr, uint64_t generation, bool dereferenceable) const noexcept {
+        if (generation != data_.Generation()) {
+            detail::HardenedFailure("use of an invalidated Vector iterator", ReallocationSiteName(reallocated_by_));
+        }
+        const T* first = data_.GetAddress();
+        if (ptr < first || ptr > first + size_ || (dereferenceable && ptr == first + size_)) {
+            detail::HardenedFailure("Vector iterator out of range");
+        }
+    }
+
+    void CheckPosition(const_iterator pos, bool dereferenceable) const noexcept {
+        if (pos.GetOwner() != this) {
+            detail::HardenedFailure("position is not an iterator of this Vector");
+        }
+        pos.Get(dereferenceable);
+    }
+#else
+    static iterator MakeIterator(T* ptr) noexcept {
+        return ptr;
+    }
+    static const_iterator MakeIterator(const T* ptr) noexcept {
+        return ptr;
+    }
+
+    static void CheckPosition(const_iterator /*pos*/, bool /*dereferenceable*/) noexcept {
+    }
+
+    static void SwapIteratorOwners(Vector& /*other*/) noexcept {
+    }
+#endif
+
+    // Сообщает о перевыделении политике инструментирования, а в защищённом режиме
+    // запоминает место, чтобы назвать его при обращении через устаревший итератор
+    void OnReallocation([[maybe_unused]] ReallocationSite site) noexcept {
+        Stats::OnReallocation(site);
+#if ADVANCED_VECTOR_HARDENED
+        reallocated_by_ = site;
+#endif
+    }
+
+    // Вместимость буфера, в который поместятся required элементов, согласно стратегии роста
+    size_t NextCapacity(size_t required) const noexcept {
+        return Growth::NextCapacity(Capacity(), required, sizeof(T));
+    }
+
+    void SwapStorage(Vector& other) noexcept {
         data_.Swap(other.data_);
         std::swap(size_, other.size_);
+#if ADVANCED_VECTOR_HARDENED
+        std::swap(reallocated_by_, other.reallocated_by_);
+#endif
     }
 
-private:
     void CopyFrom(const Vector& rhs) {
-        size_t cp_size = std::min(size_, rhs.size_);
-        auto it = std::copy_n(rhs.data_.GetAddress(), cp_size, data_.GetAddress());
+        const size_t cp_size = std::min(size_, rhs.size_);
+        const T* src = rhs.data_.GetAddress();
+        T* dst = data_.GetAddress();
+        detail::BulkFor(cp_size, sizeof(T), [src, dst](size_t first, size_t count) {
+            std::copy_n(src + first, count, dst + first);
+        });
         if (size_ > rhs.size_) {
-            std::destroy_n(it, size_ - cp_size);
+            detail::BulkDestroy(dst + cp_size, size_ - cp_size);
         } else {
-            std::uninitialized_copy_n(rhs.data_.GetAddress() + cp_size, rhs.size_ - cp_size, it);
+            detail::BulkConstruct(dst + cp_size, rhs.size_ - cp_size, [src, dst, cp_size](size_t first, size_t count) {
+                std::uninitialized_copy_n(src + cp_size + first, count, dst + cp_size + first);
+            });
         }
         size_ = rhs.size_;
     }
-    void CopyTo(RawMemory<T>& new_data, size_t from, size_t to, size_t pos) {
+    void CopyTo(Memory& new_data, size_t from, size_t to, size_t pos) {
+        T* src = data_ + from;
+        T* dst = new_data + pos;
+        detail::BulkConstruct(dst, to - from, [src, dst](size_t first, size_t count) {
+            detail::UninitializedTransferN(src + first, count, dst + first);
+        });
         if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(data_.GetAddress() + from, to - from, new_data.GetAddress() + pos);
+            Stats::OnMove(to - from);
         } else {
-            std::uninitialized_copy_n(data_.GetAddress() + from, to - from, new_data.GetAddress() + pos);
+            Stats::OnCopy(to - from);
         }
     }
 
-    void SwapCopy(RawMemory<T>& new_data) {
-        CopyTo(new_data, 0, size_, 0);
-        std::destroy_n(data_.GetAddress(), size_);
+    // Побайтовый аналог CopyTo для тривиально переносимых элементов
+    void RelocateTo(Memory& new_data, size_t from, size_t to, size_t pos) noexcept {
+        T* src = data_ + from;
+        T* dst = new_data + pos;
+        detail::BulkFor(to - from, sizeof(T), [src, dst](size_t first, size_t count) noexcept {
+            detail::RelocateBytes(src + first, count, dst + first);
+        });
+        Stats::OnRelocate(to - from);
+    }
+
+    void SwapCopy(Memory& new_data) {
+        if constexpr (kRelocateBytes) {
+            RelocateTo(new_data, 0, size_, 0);
+        } else {
+            CopyTo(new_data, 0, size_, 0);
+            detail::BulkDestroy(data_.GetAddress(), size_);
+        }
         data_.Swap(new_data);
     }
-    RawMemory<T> data_;
+
+    // Сжимает буфер, если этого требует стратегия Shrink. Сжатие - лишь оптимизация: при неудачном
+    // перевыделении вектор остаётся прежним благодаря строгой гарантии Reallocate
+    void MaybeShrink() noexcept {
+        if constexpr (Shrink::kEnabled) {
+            const size_t new_capacity = Shrink::ShrinkCapacity(size_, Capacity());
+            if (new_capacity < Capacity()) {
+                try {
+                    Reallocate(std::max(new_capacity, size_), ReallocationSite::kShrink);
+                } catch (...) {
+                }
+            }
+        }
+    }
+
+    // Увеличивает вместимость согласно стратегии роста, если required элементов не помещаются
+    void Grow(size_t required) {
+        if (required > Capacity()) {
+            Reallocate(NextCapacity(required), ReallocationSite::kInsertRange);
+        }
+    }
+
+    // Вставляет count элементов перед позицией idx. construct(dst, from, n) конструирует элементы
+    // [from, from + n) вставляемой последовательности в сырой памяти dst,
+    // assign(dst, from, n) присваивает их живым элементам, начиная с dst
+    template <typename Construct, typename Assign>
+    void InsertN(size_t idx, size_t count, Construct construct, Assign assign) {
+        if (count == 0) {
+            return;
+        }
+        if (size_ + count > Capacity()) {
+            Memory new_data(NextCapacity(size_ + count), GetAllocator());
+            construct(new_data + idx, 0, count);
+            OnReallocation(ReallocationSite::kInsertRange);
+            if constexpr (kRelocateBytes) {
+                RelocateTo(new_data, 0, idx, 0);
+                RelocateTo(new_data, idx, size_, idx + count);
+            } else {
+                try {
+                    CopyTo(new_data, 0, idx, 0);
+                } catch (...) {
+                    std::destroy_n(new_data + idx, count);
+                    throw;
+                }
+                try {
+                    CopyTo(new_data, idx, size_, idx + count);
+                } catch (...) {
+                    std::destroy_n(new_data.GetAddress(), idx + count);
+                    throw;
+                }
+                std::destroy_n(data_.GetAddress(), size_);
+            }
+            data_.Swap(new_data);
+        } else if constexpr (kRelocateBytes) {
+            // Хвост сдвигается побайтово и возвращается на место, если конструирование не удалось
+            T* gap = data_ + idx;
+            detail::RelocateBytesOverlapping(gap, size_ - idx, gap + count);
+            try {
+                construct(gap, 0, count);
+            } catch (...) {
+                detail::RelocateBytesOverlapping(gap + count, size_ - idx, gap);
+                throw;
+            }
+        } else {
+            T* pos = data_ + idx;
+            T* old_end = data_ + size_;
+            const size_t elems_after = size_ - idx;
+            if (elems_after > count) {
+                std::uninitialized_move(old_end - count, old_end, old_end);
+                size_ += count;
+                std::move_backward(pos, old_end - count, old_end);
+                assign(pos, 0, count);
+            } else {
+                construct(old_end, elems_after, count - elems_after);
+                try {
+                    std::uninitialized_move(pos, old_end, old_end + (count - elems_after));
+                } catch (...) {
+                    std::destroy_n(old_end, count - elems_after);
+                    throw;
+                }
+                size_ += count;
+                assign(pos, 0, elems_after);
+            }
+            return;
+        }
+        size_ += count;
+    }
+
+    // Вставляет элемент в позицию idx при свободном месте в буфере
+    template <typename... Args>
+    void EmplaceInPlace(size_t idx, Args&&... args) {
+        if (idx == size_) {
+            new (data_ + size_) T(std::forward<Args>(args)...);
+            ++size_;
+        } else if constexpr (kRelocateBytes) {
+            // Аргументы могут ссылаться на элементы, поэтому объект создаётся до сдвига хвоста
+            detail::RelocationSlot<T> slot(std::forward<Args>(args)...);
+            detail::RelocateBytesOverlapping(data_ + idx, size_ - idx, data_ + idx + 1);
+            slot.RelocateTo(data_ + idx);
+            ++size_;
+        } else if constexpr (detail::kIsElementArgument<T, Args...>) {
+            AssignShifted(idx, std::forward<Args>(args)...);
+        } else {
+            T tmp(std::forward<Args>(args)...);
+            ShiftTailRight(idx);
+            data_[idx] = std::move(tmp);
+        }
+    }
+
+    // Присваивает готовый объект в освобождённую позицию idx без временной копии. Если value
+    // - элемент из сдвигаемого хвоста, после сдвига он читается с нового места
+    template <typename Value>
+    void AssignShifted(size_t idx, Value&& value) {
+        auto* src = std::addressof(value);
+        const std::less<const T*> before;
+        const bool in_tail = !before(src, data_ + idx) && before(src, data_ + size_);
+        ShiftTailRight(idx);
+        data_[idx] = std::forward<Value>(*(in_tail ? src + 1 : src));
+    }
+
+    // Сдвигает элементы [idx, size_) на одну позицию вправо: последний элемент
+    // перемещается в неинициализированную память, остальные - присваиванием
+    void ShiftTailRight(size_t idx) {
+        new (data_ + size_) T(std::move(data_[size_ - 1]));
+        ++size_;
+        std::move_backward(begin() + idx, end() - 2, end() - 1);
+    }
+
+    // Переносит элементы в буфер вместимостью new_capacity
+    void Reallocate(size_t new_capacity, ReallocationSite site) {
+        OnReallocation(site);
+        if constexpr (kReallocateInPlace) {
+            data_.Reallocate(new_capacity);
+            Stats::OnRelocate(size_);
+        } else {
+            Memory new_data(new_capacity, GetAllocator());
+            SwapCopy(new_data);
+        }
+    }
+    Memory data_;
     size_t size_ = 0;
+#if ADVANCED_VECTOR_HARDENED
+    // Место последнего перевыделения; kCount - буфер выделен при конструировании
+    ReallocationSite reallocated_by_ = ReallocationSite::kCount;
+    mutable std::shared_ptr<detail::IteratorOwner<Vector>> iterator_owner_;
+#endif
 };
+
+// Удаляет из вектора элементы, для которых pred истинен. Возвращает количество удалённых элементов
+template <typename Predicate, typename T, typename... Params>
+size_t EraseIf(Vector<T, Params...>& vec, Predicate pred) {
+    return vec.Compact(std::move(pred));
+}
+
+// Векторы равны, если равны их размеры и элементы. Элементы без заполнителей и с единственным
+// представлением каждого значения сравниваются как память
+template <typename T, typename... Params>
+bool operator==(const Vector<T, Params...>& lhs, const Vector<T, Params...>& rhs) {
+    if (lhs.Size() != rhs.Size()) {
+        return false;
+    }
+    if constexpr (std::has_unique_object_representations_v<T>) {
+        return lhs.Size() == 0 || std::memcmp(lhs.Data(), rhs.Data(), lhs.Size() * sizeof(T)) == 0;
+    } else {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+}
+
+template <typename T, typename... Params>
+bool operator!=(const Vector<T, Params...>& lhs, const Vector<T, Params...>& rhs) {
+    return !(lhs == rhs);
+}
+
+// Находится через ADL: std::swap, std::sort и другие алгоритмы обменивают векторы без копирования
+template <typename T, typename... Params>
+void swap(Vector<T, Params...>& lhs, Vector<T, Params...>& rhs) noexcept {
+    lhs.Swap(rhs);
+}
+
+// Контейнеры из векторов (std::vector<Vector<T>>, Vector<Vector<T>>) при росте перемещают
+// внутренние векторы, только если перемещение не выбрасывает исключений
+static_assert(std::is_nothrow_move_constructible_v<Vector<int>>);
+static_assert(std::is_nothrow_move_assignable_v<Vector<int>>);
+static_assert(std::is_nothrow_swappable_v<Vector<int>>);
+static_assert(std::is_nothrow_move_constructible_v<Vector<Vector<int>>>);
+static_assert(std::is_nothrow_move_assignable_v<Vector<Vector<int>>>);
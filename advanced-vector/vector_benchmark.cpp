@@ -0,0 +1,397 @@
+// Сравнение Vector и std::vector (в том числе вложенных), FlatMap и std::map, чтения байтов
+// из дескриптора на Google Benchmark.
+//
+// Сборка:  g++ -std=c++17 -O2 vector_benchmark.cpp -lbenchmark -lpthread -o vector_benchmark
+// Отчёт:   ./vector_benchmark --benchmark_out=result.json --benchmark_out_format=json
+// Регрессии ищутся сравнением двух отчётов скриптом tools/compare.py из Google Benchmark
+#include "byte_io.h"
+#include "flat_map.h"
+#include "vector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+
+namespace {
+
+// Тривиально копируемая запись на 16 байт
+struct Pod16 {
+    int64_t key;
+    int64_t value;
+};
+
+// Тип с перемещением, не выбрасывающим исключений
+using NothrowMovable = std::string;
+
+// Тип, перемещение которого может выбросить исключение: Vector и std::vector копируют его при росте
+struct ThrowingMove {
+    ThrowingMove() = default;
+    explicit ThrowingMove(std::string s)
+        : str(std::move(s)) {
+    }
+    ThrowingMove(const ThrowingMove&) = default;
+    ThrowingMove(ThrowingMove&& other) noexcept(false)
+        : str(std::move(other.str)) {
+    }
+    ThrowingMove& operator=(const ThrowingMove&) = default;
+    ThrowingMove& operator=(ThrowingMove&& other) noexcept(false) {
+        str = std::move(other.str);
+        return *this;
+    }
+
+    std::string str;
+};
+
+// Крупный тривиально копируемый тип
+struct Large {
+    std::array<int64_t, 32> payload;
+};
+
+template <typename T>
+T Make(size_t i);
+
+template <>
+Pod16 Make<Pod16>(size_t i) {
+    return {static_cast<int64_t>(i), static_cast<int64_t>(i * 3)};
+}
+
+template <>
+NothrowMovable Make<NothrowMovable>(size_t i) {
+    return std::string(24, static_cast<char>('a' + i % 26));
+}
+
+template <>
+ThrowingMove Make<ThrowingMove>(size_t i) {
+    return ThrowingMove(Make<NothrowMovable>(i));
+}
+
+template <>
+Large Make<Large>(size_t i) {
+    Large large{};
+    large.payload.fill(static_cast<int64_t>(i));
+    return large;
+}
+
+int64_t Weight(const Pod16& x) {
+    return x.value;
+}
+
+int64_t Weight(const NothrowMovable& x) {
+    return static_cast<int64_t>(x.size());
+}
+
+int64_t Weight(const ThrowingMove& x) {
+    return static_cast<int64_t>(x.str.size());
+}
+
+int64_t Weight(const Large& x) {
+    return x.payload[0];
+}
+
+// Единый интерфейс к Vector и std::vector
+
+template <typename T>
+void PushBack(Vector<T>& v, const T& value) {
+    v.PushBack(value);
+}
+
+template <typename T>
+void PushBack(std::vector<T>& v, const T& value) {
+    v.push_back(value);
+}
+
+template <typename T>
+void EmplaceBack(Vector<T>& v, T&& value) {
+    v.EmplaceBack(std::move(value));
+}
+
+template <typename T>
+void EmplaceBack(std::vector<T>& v, T&& value) {
+    v.emplace_back(std::move(value));
+}
+
+template <typename T>
+void Reserve(Vector<T>& v, size_t n) {
+    v.Reserve(n);
+}
+
+template <typename T>
+void Reserve(std::vector<T>& v, size_t n) {
+    v.reserve(n);
+}
+
+template <typename T>
+void InsertAt(Vector<T>& v, size_t idx, const T& value) {
+    v.Insert(v.begin() + idx, value);
+}
+
+template <typename T>
+void InsertAt(std::vector<T>& v, size_t idx, const T& value) {
+    v.insert(v.begin() + idx, value);
+}
+
+template <typename T>
+void EraseAt(Vector<T>& v, size_t idx) {
+    v.Erase(v.begin() + idx);
+}
+
+template <typename T>
+void EraseAt(std::vector<T>& v, size_t idx) {
+    v.erase(v.begin() + idx);
+}
+
+template <typename Container>
+Container MakeFilled(size_t n) {
+    using T = typename Container::value_type;
+    Container c;
+    Reserve(c, n);
+    for (size_t i = 0; i < n; ++i) {
+        PushBack(c, Make<T>(i));
+    }
+    return c;
+}
+
+// Рост с нуля без предварительного резервирования
+template <typename Container>
+void BM_PushBack(benchmark::State& state) {
+    using T = typename Container::value_type;
+    const size_t n = state.range(0);
+    const T value = Make<T>(0);
+    for (auto _ : state) {
+        Container c;
+        for (size_t i = 0; i < n; ++i) {
+            PushBack(c, value);
+        }
+        benchmark::DoNotOptimize(c.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename Container>
+void BM_EmplaceBack(benchmark::State& state) {
+    using T = typename Container::value_type;
+    const size_t n = state.range(0);
+    for (auto _ : state) {
+        Container c;
+        for (size_t i = 0; i < n; ++i) {
+            EmplaceBack(c, Make<T>(i));
+        }
+        benchmark::DoNotOptimize(c.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename Container>
+void BM_ReserveFill(benchmark::State& state) {
+    using T = typename Container::value_type;
+    const size_t n = state.range(0);
+    const T value = Make<T>(0);
+    for (auto _ : state) {
+        Container c;
+        Reserve(c, n);
+        for (size_t i = 0; i < n; ++i) {
+            PushBack(c, value);
+        }
+        benchmark::DoNotOptimize(c.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+enum class Position { kFront, kMiddle, kBack };
+
+// Вставка и удаление одного элемента в заданной позиции вектора из n элементов
+template <typename Container, Position Pos>
+void BM_InsertErase(benchmark::State& state) {
+    using T = typename Container::value_type;
+    const size_t n = state.range(0);
+    Container c = MakeFilled<Container>(n);
+    const T value = Make<T>(n);
+    const size_t idx = Pos == Position::kFront ? 0 : Pos == Position::kMiddle ? n / 2 : n;
+    for (auto _ : state) {
+        InsertAt(c, idx, value);
+        EraseAt(c, idx);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+template <typename Container>
+void BM_CopyAssign(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const Container src = MakeFilled<Container>(n);
+    Container dst;
+    for (auto _ : state) {
+        dst = src;
+        benchmark::DoNotOptimize(dst.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename Container>
+void BM_MoveAssign(benchmark::State& state) {
+    Container a = MakeFilled<Container>(state.range(0));
+    Container b;
+    for (auto _ : state) {
+        b = std::move(a);
+        a = std::move(b);
+        benchmark::DoNotOptimize(a.begin());
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+template <typename Container>
+void BM_Iterate(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const Container c = MakeFilled<Container>(n);
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (const auto& x : c) {
+            sum += Weight(x);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetBytesProcessed(state.iterations() * n * sizeof(typename Container::value_type));
+}
+
+// Внешний контейнер из n векторов по 16 элементов растёт с нуля. Внутренние векторы
+// перемещаются при росте, только если их перемещение не выбрасывает исключений
+template <typename Outer>
+void BM_NestedPushBack(benchmark::State& state) {
+    using Inner = typename Outer::value_type;
+    const size_t n = state.range(0);
+    const Inner prototype = MakeFilled<Inner>(16);
+    for (auto _ : state) {
+        Outer outer;
+        for (size_t i = 0; i < n; ++i) {
+            Inner inner(prototype);
+            EmplaceBack(outer, std::move(inner));
+        }
+        benchmark::DoNotOptimize(outer);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+static_assert(std::is_nothrow_move_constructible_v<Vector<Pod16>>);
+static_assert(std::is_nothrow_move_constructible_v<Vector<NothrowMovable>>);
+static_assert(std::is_nothrow_move_constructible_v<Vector<ThrowingMove>>);
+
+// Чтение range(0) байт из /dev/zero порциями по 64 КБ: через буфер на стеке и PushBack по байту
+// или прямо в свободный хвост вектора через ReadFrom
+constexpr size_t kReadChunk = 1 << 16;
+
+void BM_ReadStackBuffer(benchmark::State& state) {
+    const int fd = ::open("/dev/zero", O_RDONLY);
+    const size_t n = state.range(0);
+    for (auto _ : state) {
+        Vector<char> vec;
+        char buf[kReadChunk];
+        while (vec.Size() < n) {
+            const ssize_t got = ::read(fd, buf, std::min(kReadChunk, n - vec.Size()));
+            for (ssize_t i = 0; i < got; ++i) {
+                vec.PushBack(buf[i]);
+            }
+        }
+        benchmark::DoNotOptimize(vec.Data());
+    }
+    ::close(fd);
+    state.SetBytesProcessed(state.iterations() * n);
+}
+
+void BM_ReadFrom(benchmark::State& state) {
+    const int fd = ::open("/dev/zero", O_RDONLY);
+    const size_t n = state.range(0);
+    for (auto _ : state) {
+        Vector<char> vec;
+        while (vec.Size() < n) {
+            ReadFrom(fd, vec, std::min(kReadChunk, n - vec.Size()));
+        }
+        benchmark::DoNotOptimize(vec.Data());
+    }
+    ::close(fd);
+    state.SetBytesProcessed(state.iterations() * n);
+}
+
+template <typename Outer>
+void RegisterNested(const std::string& name) {
+    benchmark::RegisterBenchmark(("NestedPushBack/" + name).c_str(), BM_NestedPushBack<Outer>)
+        ->RangeMultiplier(16)
+        ->Range(16, 1 << 16);
+}
+
+int64_t* FindValue(std::map<int64_t, int64_t>& map, int64_t key) {
+    const auto it = map.find(key);
+    return it != map.end() ? &it->second : nullptr;
+}
+
+int64_t* FindValue(FlatMap<int64_t, int64_t>& map, int64_t key) {
+    return map.Find(key);
+}
+
+// Поиск в таблице из n ключей с шагом 2: половина запросов не находит ключ. n - степень двойки
+template <typename Map>
+void BM_Lookup(benchmark::State& state) {
+    const int64_t n = state.range(0);
+    Map map;
+    for (int64_t i = 0; i < n; ++i) {
+        map[2 * i] = i;
+    }
+    uint64_t probe = 1;
+    for (auto _ : state) {
+        probe = probe * 6364136223846793005ULL + 1442695040888963407ULL;
+        benchmark::DoNotOptimize(FindValue(map, static_cast<int64_t>((probe >> 33) & (2 * n - 1))));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename Container>
+void RegisterContainer(const std::string& name) {
+    const auto reg = [&name](const std::string& op, void (*fn)(benchmark::State&), int64_t max_size) {
+        benchmark::RegisterBenchmark((op + "/" + name).c_str(), fn)->RangeMultiplier(16)->Range(16, max_size);
+    };
+    reg("PushBack", BM_PushBack<Container>, 1 << 20);
+    reg("EmplaceBack", BM_EmplaceBack<Container>, 1 << 20);
+    reg("ReserveFill", BM_ReserveFill<Container>, 1 << 20);
+    reg("InsertErase/Front", BM_InsertErase<Container, Position::kFront>, 1 << 16);
+    reg("InsertErase/Middle", BM_InsertErase<Container, Position::kMiddle>, 1 << 16);
+    reg("InsertErase/Back", BM_InsertErase<Container, Position::kBack>, 1 << 16);
+    reg("CopyAssign", BM_CopyAssign<Container>, 1 << 20);
+    reg("MoveAssign", BM_MoveAssign<Container>, 1 << 20);
+    reg("Iterate", BM_Iterate<Container>, 1 << 20);
+}
+
+template <typename T>
+void RegisterType(const std::string& type_name) {
+    RegisterContainer<Vector<T>>("Vector<" + type_name + ">");
+    RegisterContainer<std::vector<T>>("std::vector<" + type_name + ">");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    RegisterType<Pod16>("Pod16");
+    RegisterType<NothrowMovable>("NothrowMovable");
+    RegisterType<ThrowingMove>("ThrowingMove");
+    RegisterType<Large>("Large");
+    RegisterNested<Vector<Vector<Pod16>>>("Vector<Vector<Pod16>>");
+    RegisterNested<std::vector<Vector<Pod16>>>("std::vector<Vector<Pod16>>");
+    RegisterNested<std::vector<std::vector<Pod16>>>("std::vector<std::vector<Pod16>>");
+    benchmark::RegisterBenchmark("Read/StackBuffer", BM_ReadStackBuffer)->RangeMultiplier(16)->Range(1 << 16, 1 << 24);
+    benchmark::RegisterBenchmark("Read/ReadFrom", BM_ReadFrom)->RangeMultiplier(16)->Range(1 << 16, 1 << 24);
+    benchmark::RegisterBenchmark("Lookup/FlatMap", BM_Lookup<FlatMap<int64_t, int64_t>>)->RangeMultiplier(16)->Range(16, 1 << 20);
+    benchmark::RegisterBenchmark("Lookup/std::map", BM_Lookup<std::map<int64_t, int64_t>>)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,281 @@
+#pragma once
+#include "vector.h"
+
+// Невладеющие представления непрерывных последовательностей элементов (Vector, MappedVector и др.):
+// VectorView - подотрезок, StridedView - элементы с постоянным шагом в байтах, например каждый
+// k-й элемент или поле структуры в массиве структур. Представления не продлевают жизнь элементов
+// и становятся недействительными вместе с итераторами исходного контейнера
+
+template <typename T>
+class StridedView;
+
+template <typename T>
+class VectorView {
+    template <typename Container>
+    using ElementOf = std::remove_pointer_t<decltype(std::declval<Container&>().Data())>;
+
+public:
+    using value_type = std::remove_cv_t<T>;
+    using iterator = T*;
+    using const_iterator = T*;
+
+    static constexpr size_t kToEnd = std::numeric_limits<size_t>::max();
+
+    VectorView() = default;
+
+    VectorView(T* data, size_t size) noexcept
+        : data_(data)
+        , size_(size) {
+    }
+
+    // VectorView<T> неявно приводится к VectorView<const T>
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+    VectorView(const VectorView<U>& other) noexcept
+        : data_(other.Data())
+        , size_(other.Size()) {
+    }
+
+    // Представление всех элементов контейнера с функциями Data() и Size()
+    template <typename Container,
+              typename = std::enable_if_t<std::is_convertible_v<ElementOf<Container> (*)[], T (*)[]>>>
+    VectorView(Container& container) noexcept
+        : data_(container.Data())
+        , size_(container.Size()) {
+    }
+
+    T* Data() const noexcept {
+        return data_;
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    bool Empty() const noexcept {
+        return size_ == 0;
+    }
+
+    iterator begin() const noexcept {
+        return data_;
+    }
+    iterator end() const noexcept {
+        return data_ + size_;
+    }
+
+    T& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    // count элементов, начиная с offset. Значение kToEnd или выход за конец ограничиваются концом
+    VectorView Subview(size_t offset, size_t count = kToEnd) const noexcept {
+        assert(offset <= size_);
+        return {data_ + offset, std::min(count, size_ - offset)};
+    }
+
+    VectorView First(size_t count) const noexcept {
+        assert(count <= size_);
+        return {data_, count};
+    }
+
+    VectorView Last(size_t count) const noexcept {
+        assert(count <= size_);
+        return {data_ + size_ - count, count};
+    }
+
+    // Каждый step-й элемент, начиная с offset
+    StridedView<T> EveryNth(size_t step, size_t offset = 0) const noexcept;
+
+#if defined(__cpp_lib_span)
+    operator std::span<T>() const noexcept {
+        return {data_, size_};
+    }
+#endif
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+template <typename Container>
+VectorView(Container&) -> VectorView<std::remove_pointer_t<decltype(std::declval<Container&>().Data())>>;
+
+template <typename T>
+class StridedView {
+    using Byte = std::conditional_t<std::is_const_v<T>, const unsigned char, unsigned char>;
+
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_cv_t<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        Iterator() = default;
+        Iterator(Byte* pos, std::ptrdiff_t stride) noexcept
+            : pos_(pos)
+            , stride_(stride) {
+        }
+
+        reference operator*() const noexcept {
+            return *reinterpret_cast<T*>(pos_);
+        }
+        pointer operator->() const noexcept {
+            return &**this;
+        }
+        reference operator[](difference_type n) const noexcept {
+            return *(*this + n);
+        }
+
+        Iterator& operator++() noexcept {
+            pos_ += stride_;
+            return *this;
+        }
+        Iterator operator++(int) noexcept {
+            Iterator copy = *this;
+            ++*this;
+            return copy;
+        }
+        Iterator& operator--() noexcept {
+            pos_ -= stride_;
+            return *this;
+        }
+        Iterator operator--(int) noexcept {
+            Iterator copy = *this;
+            --*this;
+            return copy;
+        }
+        Iterator& operator+=(difference_type n) noexcept {
+            pos_ += n * stride_;
+            return *this;
+        }
+        Iterator& operator-=(difference_type n) noexcept {
+            pos_ -= n * stride_;
+            return *this;
+        }
+        friend Iterator operator+(Iterator it, difference_type n) noexcept {
+            return it += n;
+        }
+        friend Iterator operator+(difference_type n, Iterator it) noexcept {
+            return it += n;
+        }
+        friend Iterator operator-(Iterator it, difference_type n) noexcept {
+            return it -= n;
+        }
+        friend difference_type operator-(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return (lhs.pos_ - rhs.pos_) / lhs.stride_;
+        }
+
+        friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.pos_ == rhs.pos_;
+        }
+        friend bool operator!=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.pos_ != rhs.pos_;
+        }
+        friend bool operator<(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs - rhs < 0;
+        }
+        friend bool operator>(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return rhs < lhs;
+        }
+        friend bool operator<=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return !(rhs < lhs);
+        }
+        friend bool operator>=(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return !(lhs < rhs);
+        }
+
+    private:
+        Byte* pos_ = nullptr;
+        std::ptrdiff_t stride_ = sizeof(T);
+    };
+
+    using value_type = std::remove_cv_t<T>;
+    using iterator = Iterator;
+    using const_iterator = Iterator;
+
+    StridedView() = default;
+
+    // size элементов, первый из которых находится по адресу first, а каждый следующий -
+    // на stride_bytes байт дальше
+    StridedView(T* first, size_t size, std::ptrdiff_t stride_bytes) noexcept
+        : first_(reinterpret_cast<Byte*>(first))
+        , size_(size)
+        , stride_(stride_bytes) {
+    }
+
+    StridedView(VectorView<T> view) noexcept
+        : StridedView(view.Data(), view.Size(), sizeof(T)) {
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    bool Empty() const noexcept {
+        return size_ == 0;
+    }
+
+    // Шаг между соседними элементами в байтах
+    std::ptrdiff_t Stride() const noexcept {
+        return stride_;
+    }
+
+    iterator begin() const noexcept {
+        return {first_, stride_};
+    }
+    iterator end() const noexcept {
+        return {first_ + static_cast<std::ptrdiff_t>(size_) * stride_, stride_};
+    }
+
+    T& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return begin()[index];
+    }
+
+    StridedView Subview(size_t offset, size_t count = VectorView<T>::kToEnd) const noexcept {
+        assert(offset <= size_);
+        return {At(offset), std::min(count, size_ - offset), stride_};
+    }
+
+    StridedView EveryNth(size_t step, size_t offset = 0) const noexcept {
+        assert(step > 0 && offset <= size_);
+        return {At(offset), (size_ - offset + step - 1) / step, stride_ * static_cast<std::ptrdiff_t>(step)};
+    }
+
+private:
+    T* At(size_t index) const noexcept {
+        return reinterpret_cast<T*>(first_ + static_cast<std::ptrdiff_t>(index) * stride_);
+    }
+
+    Byte* first_ = nullptr;
+    size_t size_ = 0;
+    std::ptrdiff_t stride_ = sizeof(T);
+};
+
+template <typename T>
+StridedView<T> VectorView<T>::EveryNth(size_t step, size_t offset) const noexcept {
+    return StridedView<T>(*this).EveryNth(step, offset);
+}
+
+// Каждый step-й элемент контейнера или представления, начиная с offset
+template <typename Range>
+auto EveryNth(Range&& range, size_t step, size_t offset = 0) noexcept {
+    return VectorView(range).EveryNth(step, offset);
+}
+
+// Поле member всех элементов массива структур:
+// Column(records, &Record::price) - представление цен без копирования
+template <typename Range, typename Class, typename Member>
+auto Column(Range&& range, Member Class::*member) noexcept {
+    const auto view = VectorView(range);
+    using Element = std::remove_reference_t<decltype(view[0])>;
+    static_assert(std::is_same_v<std::remove_cv_t<Element>, Class>, "member of another class");
+    using Field = std::conditional_t<std::is_const_v<Element>, const Member, Member>;
+    if (view.Empty()) {
+        return StridedView<Field>();
+    }
+    return StridedView<Field>(&(view.Data()->*member), view.Size(), sizeof(Element));
+}